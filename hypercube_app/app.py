@@ -16,6 +16,7 @@ from common.task import Task
 from master.master import HyperMaster, JobInfo
 from hypercube_app.create_slabs import create_slabs
 from hypercube_app.combine import combine_slabs
+from hypercube_app.merge_accumulators import merge_accumulators
 
 def byID(task : Task):
 	return task.task_id
@@ -23,6 +24,29 @@ def byID(task : Task):
 image_width = 1080
 image_height = 720
 slab_dim = 100
+sppm_workers = 8
+
+def create_sppm_tasks(parse_json, job_id, num_workers : int) -> List:
+	"""
+	Photon mapping splits the iterations instead of the image: every worker
+	renders the whole frame and returns its raw accumulator
+	"""
+	tasks : List = []
+	for i in range(num_workers):
+		parse_json["integrator"]["worker_index"] = i
+		parse_json["integrator"]["worker_count"] = num_workers
+		parse_json["integrator"]["accumulator_file"] = f"accum_{i}.bin"
+		parse_json["slab_startx"] = 0
+		parse_json["slab_endx"] = image_width
+		parse_json["slab_starty"] = 0
+		parse_json["slab_endy"] = image_height
+		parse_json["output_file"] = "job/" + str(job_id) + f"/output_{i}.bmp"
+
+		ARGS = [f'payload_{i}.txt', f'output_{i}.txt']
+		PAYLOAD = str.encode(json_dumps(parse_json))
+		tasks.append(Task(i, "./render.sh", ARGS, PAYLOAD, \
+			f"accum_{i}.bin", f"payload_{i}.txt"))
+	return tasks
 
 if __name__ == "__main__":
     # Step 1: Initialise HyperMaster
@@ -48,6 +72,10 @@ if __name__ == "__main__":
 	with open(job.job_path + "/scene.json", 'r') as json_file:
 		parse_json = json_loads(json_file.read())
 		print(parse_json["image_height"])
+		using_sppm = "integrator" in parse_json
+		if using_sppm:
+			task_list = create_sppm_tasks(parse_json, master.job.job_id, sppm_workers)
+			slab_coordinates = []
 		PROGRAM = "./render.sh"
 		i = 0
 		for slab in slab_coordinates:
@@ -88,19 +116,24 @@ if __name__ == "__main__":
 		completed_tasks: List[Task] = master.get_completed_tasks()
 		completed_tasks.sort(key=byID)
 
-		# Step 10: Create image files for the tasks
+		# Step 10: Create image (or accumulator) files for the tasks
 		i = 0
 		task_filenames = []
 		for task in completed_tasks:
-			output_filename = working_dir + "/" + f"output_{i}.bmp"
+			output_name = f"accum_{i}.bin" if using_sppm else f"output_{i}.bmp"
+			output_filename = working_dir + "/" + output_name
 			i += 1
 			with open(output_filename, "wb") as output:
 				output.write(task.payload)
 				task_filenames.append(output_filename)
 				output.flush()
 
-		# Step 11: Combine the images using slab recombination
-		combine_slabs(task_filenames, image_width, image_height)
+		# Step 11: Combine the images using slab recombination, or sum the
+		# photon mapping accumulators
+		if using_sppm:
+			merge_accumulators(task_filenames, 'render.jpg')
+		else:
+			combine_slabs(task_filenames, image_width, image_height)
 
 		end_time = time.time()
 		print("{} seconds to complete".format(end_time - start_time))
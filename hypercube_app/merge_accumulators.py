@@ -0,0 +1,60 @@
+"""
+Sums the raw accumulators written by distributed SPPM workers and tone maps
+the result into the final image
+"""
+
+import struct
+import sys
+from array import array
+from typing import List, Tuple
+
+from PIL import Image
+
+HEADER = struct.Struct('<4sIII')
+
+def read_accumulator(filename : str) -> Tuple[int, int, int, array]:
+	with open(filename, 'rb') as acc_file:
+		tag, width, height, iterations = HEADER.unpack(acc_file.read(HEADER.size))
+		if tag != b'SPPM':
+			raise ValueError(f'{filename} is not an SPPM accumulator')
+
+		values = array('f')
+		values.frombytes(acc_file.read(width * height * 3 * 4))
+		if sys.byteorder != 'little':
+			values.byteswap()
+
+	return width, height, iterations, values
+
+def merge_accumulators(filenames : List[str], output_name : str) -> int:
+	width, height, total_iterations, total = read_accumulator(filenames[0])
+
+	for name in filenames[1:]:
+		w, h, iterations, values = read_accumulator(name)
+		if (w, h) != (width, height):
+			raise ValueError(f'{name} has a different resolution')
+		total_iterations += iterations
+		for i in range(len(total)):
+			total[i] += values[i]
+
+	print(f'MERGED {len(filenames)} accumulators, {total_iterations} iterations')
+
+	# Same scaling as SPPMIntegrator::render and colour_average_max
+	scale = 1.0 / max(total_iterations, 1)
+	pixels = []
+	for i in range(0, len(total), 3):
+		r, g, b = total[i] * scale, total[i + 1] * scale, total[i + 2] * scale
+		peak = max(r, g, b)
+		if peak > 1.0:
+			r, g, b = r / peak, g / peak, b / peak
+		pixels.append((int(r * 255), int(g * 255), int(b * 255)))
+
+	image = Image.new('RGB', (width, height))
+	image.putdata(pixels)
+	image.save(output_name)
+	return total_iterations
+
+if __name__ == "__main__":
+	if len(sys.argv) < 3:
+		print(f'usage: {sys.argv[0]} output.bmp accumulator [accumulator ...]')
+		sys.exit(1)
+	merge_accumulators(sys.argv[2:], sys.argv[1])
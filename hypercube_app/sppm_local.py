@@ -0,0 +1,63 @@
+"""
+Runs a photon mapping render as several plain processes on one machine.
+Every worker traces a disjoint share of the iterations for the whole frame and
+writes a raw accumulator, which are then merged into the final image. This
+mirrors what the hypercube app does across the cluster.
+"""
+
+import subprocess
+import sys
+from argparse import ArgumentParser
+from json import dumps as json_dumps, loads as json_loads
+from pathlib import Path
+
+from hypercube_app.merge_accumulators import merge_accumulators
+
+def create_worker_tasks(scene : dict, num_workers : int, working_dir : Path):
+	tasks = []
+	for i in range(num_workers):
+		task = dict(scene)
+		task["integrator"] = dict(scene["integrator"])
+		task["integrator"]["worker_index"] = i
+		task["integrator"]["worker_count"] = num_workers
+		task["integrator"]["accumulator_file"] = str(working_dir / f'accum_{i}.bin')
+
+		# Each worker renders the whole frame
+		task["slab_startx"] = 0
+		task["slab_starty"] = 0
+		task["slab_endx"] = scene["image_width"]
+		task["slab_endy"] = scene["image_height"]
+		task["output_file"] = str(working_dir / f'output_{i}.bmp')
+
+		taskfile = working_dir / f'payload_{i}.json'
+		taskfile.write_text(json_dumps(task))
+		tasks.append((taskfile, Path(task["integrator"]["accumulator_file"])))
+	return tasks
+
+if __name__ == "__main__":
+	parser = ArgumentParser(description=__doc__)
+	parser.add_argument('scene', help='taskfile with an "integrator" section')
+	parser.add_argument('--workers', type=int, default=2)
+	parser.add_argument('--raytracer', default='./raytracer')
+	parser.add_argument('--working-dir', default='working_dir/sppm')
+	parser.add_argument('--output', default='render.bmp')
+	args = parser.parse_args()
+
+	scene = json_loads(Path(args.scene).read_text())
+	if "integrator" not in scene:
+		print('ERROR: the scene does not use the photon mapping integrator')
+		sys.exit(1)
+
+	working_dir = Path(args.working_dir)
+	Path.mkdir(working_dir, parents=True, exist_ok=True)
+
+	tasks = create_worker_tasks(scene, args.workers, working_dir)
+	workers = [subprocess.Popen([args.raytracer, str(taskfile)]) for taskfile, _ in tasks]
+
+	failed = [i for i, worker in enumerate(workers) if worker.wait() != 0]
+	if failed:
+		print(f'ERROR: workers {failed} failed')
+		sys.exit(1)
+
+	merge_accumulators([str(accumulator) for _, accumulator in tasks], args.output)
+	sys.exit(0)
@@ -45,6 +45,11 @@ namespace poly::camera {
             m_max_threads = max;
         }
 
+        std::size_t get_max_threads() const
+        {
+            return m_max_threads;
+        }
+
     protected:
         atlas::math::Point m_eye;
         atlas::math::Point m_lookat;
@@ -1,14 +1,45 @@
 #ifndef PINHOLE_HPP
 #define PINHOLE_HPP
 
+#include <functional>
+#include <string>
+#include <vector>
 #include <atlas/math/ray.hpp>
 #include "cameras/camera.hpp"
 #include "structures/world.hpp"
 #include "structures/scene_slab.hpp"
+#include "structures/visibility_buffer.hpp"
+#include "utilities/random.hpp"
 #include "utilities/utilities.hpp"
 
 namespace poly::camera {
 
+    /*
+    * Per-pixel adaptive sampling. Every pixel takes min_samples, then more
+    * until the standard error of its luminance drops below threshold or
+    * max_samples is reached. Off while max_samples is 0.
+    */
+    struct AdaptiveSampling {
+        unsigned int min_samples = 4;
+        unsigned int max_samples = 0;
+        float threshold = 0.01f;
+        // Greyscale image of the samples per pixel, not written if empty
+        std::string sample_count_file;
+    };
+
+    /*
+    * Progressive rendering. The frame is rendered in passes of
+    * samples_per_pass samples per pixel, each pass refining the whole image.
+    * Rendering stops after the last pass, once time_budget seconds have
+    * passed (never if 0) or when a stop is requested, and the image holds the
+    * average of the samples taken so far. The first pass always completes.
+    */
+    struct ProgressiveRendering {
+        bool enabled = false;
+        float time_budget = 0.0f;
+        unsigned int samples_per_pass = 1;
+    };
+
     class PinholeCamera : public Camera {
     public:
 
@@ -28,15 +59,50 @@ namespace poly::camera {
         */
         Colour colour_validate(Colour const& colour) const;
 
+        void adaptive_set(AdaptiveSampling const& adaptive);
+        void progressive_set(ProgressiveRendering const& progressive);
+        // Only progressive renders poll for stop requests
+        bool progressive() const;
+        // Trace with the wavefront tracer instead of depth first, optionally
+        // reordering each wave of secondary rays for coherence
+        void wavefront_set(bool wavefront, bool sort_secondary = true);
+        // Find the first hit of camera rays by rasterising the scene's
+        // primitives, ray tracing starts at the secondary bounces. Not used
+        // with wavefront or adaptive renders
+        void hybrid_set(bool hybrid);
+
         /*
         * Scene rendering loops
         */
-        void multithread_render_scene(poly::structures::World& world, poly::utils::BMP_info& output);
+        void multithread_render_scene(poly::structures::World const& world, poly::utils::BMP_info& output);
         void render_scene(poly::structures::World& world) const;
-        atlas::math::Ray<atlas::math::Vector> get_ray(int i, int j, poly::structures::World const& world) const;
+        atlas::math::Ray<atlas::math::Vector> get_ray(int i, int j, poly::structures::World const& world, poly::utils::Random& rng) const;
 
     private:
+        AdaptiveSampling m_adaptive;
+        ProgressiveRendering m_progressive;
+        bool m_wavefront = false;
+        bool m_sort_secondary = true;
+        bool m_hybrid = false;
+
+        atlas::math::Ray<atlas::math::Vector> sample_ray(int i, int j, unsigned int s, poly::structures::World const& world) const;
+        Colour trace_sample(int i, int j, unsigned int s, poly::structures::World const& world, std::vector<poly::object::Object const*> const& objects) const;
+        // Objects whose bounds may be seen through a slab, camera rays of the
+        // slab are only tested against these
+        std::vector<poly::object::Object const*> tile_objects(std::shared_ptr<poly::structures::scene_slab> const& slab) const;
+        std::vector<Colour> wavefront_samples(std::shared_ptr<poly::structures::scene_slab> const& slab, unsigned int first_sample, unsigned int num_samples) const;
+        void wavefront_slab(std::shared_ptr<poly::structures::scene_slab> const& slab) const;
         void render_slab(std::shared_ptr<poly::structures::scene_slab> slab) const;
+        void accumulate_slab(std::shared_ptr<poly::structures::scene_slab> const& slab, unsigned int first_sample, unsigned int num_samples) const;
+        void progressive_render(std::vector<std::shared_ptr<poly::structures::scene_slab>> const& slabs, std::size_t num_threads, poly::utils::BMP_info& output) const;
+        float render_slabs(std::vector<std::shared_ptr<poly::structures::scene_slab>> const& slabs, std::size_t num_threads, std::function<void(std::shared_ptr<poly::structures::scene_slab> const&)> const& render, std::string const& progress) const;
+        void prepare_slab(std::shared_ptr<poly::structures::scene_slab> const& slab) const;
+
+        // Hybrid rendering, see hybrid_set
+        bool project(atlas::math::Point const& point, atlas::math::Vector2& screen) const;
+        void bin_primitives(std::vector<std::shared_ptr<poly::structures::scene_slab>> const& slabs) const;
+        void rasterize_slab(std::shared_ptr<poly::structures::scene_slab> const& slab, unsigned int first_sample, unsigned int num_samples, poly::structures::VisibilityBuffer& visibility) const;
+        Colour shade_visible(poly::structures::VisibilityBuffer const& visibility, std::size_t index, poly::structures::World const& world) const;
     };
 }
 
@@ -1,6 +1,9 @@
 #ifndef INTEGRATOR_HPP
 #define INTEGRATOR_HPP
 
+#include <mutex>
+#include <string>
+#include <vector>
 //#include "objects/object.hpp"
 #include "structures/world.hpp"
 #include "cameras/pinhole.hpp"
@@ -9,6 +12,7 @@
 #include "cameras/pinhole.hpp"
 #include "structures/bounds.hpp"
 #include "structures/photon.hpp"
+#include "structures/projection_map.hpp"
 #include "lights/light.hpp"
 
 namespace poly::integrators
@@ -16,20 +20,21 @@ namespace poly::integrators
 	class VisiblePoint : public poly::object::Object
 	{
 	public:
+		// Empty slot, see SPPMIntegrator::create_visible_points
+		VisiblePoint();
 		VisiblePoint(int x_,
 					 int y_,
 					 math::Point const& point_,
 					 math::Vector const& incoming_ray_,
 					 Colour amount_,
-					 std::shared_ptr<poly::material::Material> material_,
-					 std::shared_ptr<std::vector<std::vector<Colour>>> storage,
-					 std::shared_ptr<poly::structures::World> world);
+					 poly::material::Material const* material_);
 		// Provided to allow compatibility with Object type
 		bool hit(math::Ray<math::Vector> const& R,
 				 poly::structures::SurfaceInteraction& sr) const;
 		bool shadow_hit(math::Ray<math::Vector> const& R, float& t) const;
-		void add_contribution(poly::structures::Photon const& photon,
-							  std::shared_ptr<std::mutex> storage_mutex);
+		void interaction_resolve(
+			poly::structures::SurfaceInteraction& sr) const;
+		void add_contribution(poly::structures::Photon const& photon);
 
 		// Originating Pixels
 		int index_x; // Along the x axis
@@ -45,13 +50,36 @@ namespace poly::integrators
 		Colour amount;
 
 		// Material of the object that the VisiblePoint is on
-		std::shared_ptr<poly::material::Material> surface_material;
+		poly::material::Material const* surface_material;
 
-		// Storage where the data should be stored
-		std::shared_ptr<std::vector<std::vector<Colour>>> m_storage;
+		// Direct shading and photon contributions gathered this iteration
+		Colour contribution;
+	};
+
+	class AccumulationBuffer
+	{
+	public:
+		AccumulationBuffer(int width, int height);
 
-		// World used for render
-		std::shared_ptr<poly::structures::World> m_world;
+		float fold(std::vector<std::shared_ptr<poly::object::Object>> const&
+					   visible_points);
+
+		std::vector<Colour> const& sum() const;
+		int width() const;
+		int height() const;
+
+	private:
+		// Rows per lock, small enough that concurrent folds rarely collide
+		static constexpr int band_rows = 16;
+
+		int m_width;
+		int m_height;
+
+		// Running sum of every iteration, laid out like the output image
+		std::vector<Colour> m_sum;
+
+		std::vector<std::mutex> m_band_mutexes;
+		std::vector<std::size_t> m_band_merges;
 	};
 
 	class SPPMIntegrator
@@ -66,12 +94,51 @@ namespace poly::integrators
 					poly::camera::PinholeCamera const& camera,
 					poly::utils::BMP_info& output);
 
+		/*
+		 * Restricts this process to every worker_count'th iteration, starting
+		 * at worker_index, so several processes can share one frame
+		 */
+		void set_worker(std::size_t worker_index, std::size_t worker_count);
+
+		/*
+		 * Raw (unscaled) accumulator written after the render so that the
+		 * results of several workers can be merged
+		 */
+		void set_accumulator_file(std::string const& filename);
+
+		/*
+		 * Stopping criteria, checked after each iteration. The target error
+		 * is the mean relative change of the pixel estimates between two
+		 * iterations. Zero disables either criterion.
+		 */
+		void set_target_error(float target_error);
+		void set_time_budget(float seconds);
+
+		/*
+		 * Share of each light's photons aimed at reflective and transparent
+		 * objects through its projection map, the rest cover the remaining
+		 * directions. Photon power is weighted by the solid angle covered.
+		 */
+		void set_caustic_photon_fraction(float fraction);
+
 	private:
 		std::size_t m_number_iterations;
 		float m_direct_shading_strength;
 		float m_photon_strength_multiplier;
 		std::size_t m_num_photons_per_iteration;
 		std::size_t m_num_working_areas;
+		std::size_t m_worker_index;
+		std::size_t m_worker_count;
+		std::string m_accumulator_file;
+		float m_target_error;
+		float m_time_budget;
+		float m_caustic_photon_fraction;
+
+		// One per light, built at the start of render()
+		std::vector<poly::structures::ProjectionMap> m_projection_maps;
+
+		// Edge length of the pixel tiles handed out by the camera pass
+		static constexpr int visible_point_tile_size = 16;
 
 		std::vector<std::shared_ptr<poly::object::Object>>
 		create_visible_points(
@@ -79,14 +146,14 @@ namespace poly::integrators
 			int start_y,
 			int end_x,
 			int end_y,
-			std::shared_ptr<std::vector<std::vector<Colour>>> storage,
 			poly::camera::PinholeCamera const& camera,
-			std::shared_ptr<poly::structures::World> world);
+			poly::structures::World const& world,
+			std::size_t iteration);
 
 		void photon_mapping(
 			const structures::World& world,
 			std::vector<std::shared_ptr<poly::object::Object>>& vp_list,
-			std::shared_ptr<std::mutex> storage_mutex);
+			std::size_t iteration);
 	};
 } // namespace poly::integrators
 /**
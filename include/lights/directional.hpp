@@ -17,6 +17,8 @@ namespace poly::light {
 		atlas::math::Vector direction_get([[maybe_unused]] poly::structures::SurfaceInteraction& sr);
 
 		Colour L(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world);
+		bool shadow_ray(poly::structures::SurfaceInteraction& sr, atlas::math::Ray<atlas::math::Vector>& ray) override;
+		Colour unoccluded_L(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) override;
 
         atlas::math::Point location() const override;
 
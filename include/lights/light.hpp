@@ -2,6 +2,7 @@
 #ifndef LIGHT_HPP
 #define LIGHT_HPP
 
+#include <vector>
 #include <atlas/math/math.hpp>
 #include "structures/surface_interaction.hpp"
 #include "structures/world.hpp"
@@ -14,8 +15,27 @@ namespace poly::light
 		Light();
 		virtual atlas::math::Vector get_direction(poly::structures::SurfaceInteraction& sr) = 0;
 		virtual Colour L(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) = 0;
+
+		// L split in two, so that shadow rays can be traced apart from
+		// shading: the radiance reaching sr if nothing is in the way, and the
+		// ray that must reach the light for it to count. Lights without a
+		// shadow ray return false and their unoccluded_L is exact
+		virtual bool shadow_ray(poly::structures::SurfaceInteraction& sr, atlas::math::Ray<atlas::math::Vector>& ray);
+		virtual Colour unoccluded_L(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world);
+		bool occluded(atlas::math::Ray<atlas::math::Vector> const& shadow_ray, poly::structures::World const& world);
+
+		// Tests a batch of this light's shadow rays, blocked[i] is set for
+		// every ray that does not reach the light
+		virtual void occluded(std::vector<atlas::math::Ray<atlas::math::Vector>> const& shadow_rays, poly::structures::World const& world, std::vector<bool>& blocked);
 		float ls() const;
 
+		// Emitted power used to rank lights, radiance scale times the mean
+		// of the colour
+		float power() const;
+		// Lights at a point can be placed in the light tree, the others are
+		// always shaded
+		virtual bool has_position() const;
+
 		void radiance_scale(float b);
 
 		void colour_set(Colour const& c);
@@ -21,8 +21,14 @@ namespace poly::light {
 			poly::structures::World const& world);
 
 		Colour L(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world);
+		bool shadow_ray(poly::structures::SurfaceInteraction& sr, atlas::math::Ray<atlas::math::Vector>& ray) override;
+		Colour unoccluded_L(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) override;
+
+		using Light::occluded;
+		void occluded(std::vector<atlas::math::Ray<atlas::math::Vector>> const& shadow_rays, poly::structures::World const& world, std::vector<bool>& blocked) override;
 
 		atlas::math::Point location() const override;
+		bool has_position() const override;
 
 	protected:
 		atlas::math::Point m_location;
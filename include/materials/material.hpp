@@ -1,7 +1,9 @@
 #ifndef MATERIAL_HPP
 #define MATERIAL_HPP
 
+#include <vector>
 #include <atlas/math/math.hpp>
+#include <atlas/math/ray.hpp>
 #include "structures/photon.hpp"
 #include "structures/world.hpp"
 #include "structures/KDTree.hpp"
@@ -19,10 +21,28 @@ namespace poly::material {
 		NUM_INTERACTION_TYPES
 	}; // TODO possibly move this somewhere else?*/
 
+	// A ray continuing the path from a surface, weighted by the BxDF
+	struct ScatteredRay {
+		atlas::math::Ray<atlas::math::Vector> ray;
+		atlas::math::Vector weight;
+	};
+
 	class Material {
 	public:
 		Material();
-		virtual atlas::math::Vector shade(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) const = 0;
+
+		// Shading is split into the parts below, so that the Whitted tracer
+		// and the wavefront tracer run the same material code. shade is
+		// shade_direct plus the scattered rays traced recursively
+		virtual atlas::math::Vector shade(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) const;
+		atlas::math::Vector shade_direct(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) const;
+
+		// Light reflected from sr that needs no shadow ray, e.g. ambient
+		virtual atlas::math::Vector shade_ambient(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) const;
+		// Light reflected towards the eye of radiance L arriving from w_i
+		virtual atlas::math::Vector shade_light(poly::structures::SurfaceInteraction const& sr, atlas::math::Vector const& w_i, atlas::math::Vector const& L) const;
+		// Appends the reflected and refracted rays leaving sr
+		virtual void scatter(poly::structures::SurfaceInteraction const& sr, std::vector<ScatteredRay>& rays) const;
 		
 		enum poly::structures::InteractionType m_type;
 
@@ -34,8 +34,11 @@ namespace poly::material
 
 	protected:
 		std::shared_ptr<LambertianBRDF> m_diffuse;
-		Colour shade(poly::structures::SurfaceInteraction& sr,
-					 poly::structures::World const& world) const;
+		Colour shade_ambient(poly::structures::SurfaceInteraction& sr,
+							 poly::structures::World const& world) const;
+		Colour shade_light(poly::structures::SurfaceInteraction const& sr,
+						   atlas::math::Vector const& w_i,
+						   Colour const& L) const;
 	};
 
 } // namespace poly::material
@@ -17,8 +17,11 @@ namespace poly::material
 		Phong();
 		Phong(float f_diffuse, float f_spec, Colour c, float exp);
 
-		virtual Colour shade(poly::structures::SurfaceInteraction& sr,
-							 poly::structures::World const& world) const;
+		virtual Colour shade_ambient(poly::structures::SurfaceInteraction& sr,
+									 poly::structures::World const& world) const;
+		virtual Colour shade_light(poly::structures::SurfaceInteraction const& sr,
+								   atlas::math::Vector const& w_i,
+								   Colour const& L) const;
 		virtual float get_diffuse_strength() const;
 		virtual float get_specular_strength() const;
 		virtual float get_reflective_strength() const;
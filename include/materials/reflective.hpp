@@ -19,7 +19,7 @@ namespace poly::material {
 			Colour const& _colour,
 			float _exp);
 
-		Colour shade(poly::structures::SurfaceInteraction& sr, poly::structures::World const& world) const;
+		void scatter(poly::structures::SurfaceInteraction const& sr, std::vector<ScatteredRay>& rays) const;
 		virtual float get_diffuse_strength() const;
 		virtual float get_specular_strength() const;
 		virtual float get_reflective_strength() const;
@@ -25,8 +25,8 @@ namespace poly::material
 						atlas::math::Vector& w_o,
 						atlas::math::Vector& w_t) const;
 
-		Colour shade(poly::structures::SurfaceInteraction& sr,
-					 poly::structures::World const& world) const;
+		void scatter(poly::structures::SurfaceInteraction const& sr,
+					 std::vector<ScatteredRay>& rays) const;
 
 		virtual float get_diffuse_strength() const;
 		virtual float get_specular_strength() const;
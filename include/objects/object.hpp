@@ -7,7 +7,6 @@ namespace poly::object { class Object; }
 //#include "materials/material.hpp"
 //#include "structures/surface_interaction.hpp"
 #include "structures/bounds.hpp"
-#include <mutex>
 
 namespace poly::material { class Material; }
 namespace poly::structures { class SurfaceInteraction; class Photon; }
@@ -25,8 +24,11 @@ namespace poly::object {
 		virtual bool hit(atlas::math::Ray<math::Vector>const& R,
 			poly::structures::SurfaceInteraction& sr) const = 0;
 		virtual bool shadow_hit(atlas::math::Ray<atlas::math::Vector>const& R, float& t) const = 0;
-		virtual void add_contribution([[maybe_unused]]poly::structures::Photon const& photon,
-									  [[maybe_unused]]std::shared_ptr<std::mutex> storage_mutex) {}
+
+		// hit() only records t (and barycentrics) for the closest candidate,
+		// the normal, uvs and material are filled in once the traversal is done
+		virtual void interaction_resolve(poly::structures::SurfaceInteraction& sr) const = 0;
+		virtual void add_contribution([[maybe_unused]]poly::structures::Photon const& photon) {}
 
 
 		virtual poly::structures::Bounds3D get_boundbox() const
@@ -34,6 +36,13 @@ namespace poly::object {
 			return bounds;
 		}
 
+		// Appends the primitives this object is made of, just itself unless
+		// it is an aggregate such as a KD-tree
+		virtual void append_primitives(std::vector<Object const*>& primitives) const
+		{
+			primitives.push_back(this);
+		}
+
 		void material_set(std::shared_ptr<poly::material::Material> const& material)
 		{
 			m_material = material;
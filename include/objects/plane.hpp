@@ -22,6 +22,8 @@ namespace poly::object {
 		bool shadow_hit([[maybe_unused]] math::Ray<math::Vector> const& R,
 			[[maybe_unused]] float& t) const;
 
+		void interaction_resolve(poly::structures::SurfaceInteraction& sr) const;
+
 	private:
 		math::Vector normal;
 		math::Vector position;
@@ -21,6 +21,8 @@ namespace poly::object {
         bool hit(atlas::math::Ray<math::Vector>const& R,
                  poly::structures::SurfaceInteraction& sr) const;
 
+        void interaction_resolve(poly::structures::SurfaceInteraction& sr) const;
+
         math::Vector interpolate_norm(float& beta, float& gamma) const;
 
         float interpolate_u(float& beta, float& gamma) const;
@@ -26,6 +26,8 @@ namespace poly::object {
 		bool shadow_hit(math::Ray<math::Vector> const& R,
 			float& t) const;
 
+		void interaction_resolve(poly::structures::SurfaceInteraction& sr) const;
+
 		bool get_closest_intersect(const math::Ray<math::Vector>& R,
 								   float& t_min) const;
 
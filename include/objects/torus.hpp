@@ -28,6 +28,8 @@ namespace poly::object {
 		bool shadow_hit(math::Ray<math::Vector> const& R,
 			float& t) const;
 
+		void interaction_resolve(poly::structures::SurfaceInteraction& sr) const;
+
 		bool closest_intersect_get(math::Ray<math::Vector> const& R,
 			float& t_min) const;
 
@@ -30,6 +30,8 @@ namespace poly::object {
 		bool shadow_hit(math::Ray<math::Vector>const& R,
 			float& t) const;
 
+		virtual void interaction_resolve(poly::structures::SurfaceInteraction& sr) const;
+
 		void scale(math::Vector const& scale);
 
 		void translate(math::Vector const& pos);
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef BLUE_NOISE_HPP
+#define BLUE_NOISE_HPP
+
+#include "samplers/sampler.hpp"
+
+namespace poly::sampler
+{
+	/*
+	 * R2 (plastic constant) sequence, shifted per pixel by the R2 dither
+	 * mask. The mask has blue noise like spectra, so the remaining error is
+	 * spread as high frequency noise between pixels instead of clumps.
+	 */
+	class AA_BlueNoise : public Sampler
+	{
+	public:
+		AA_BlueNoise();
+
+		AA_BlueNoise(unsigned int num_samp);
+
+		void generate_samples();
+
+		atlas::math::Vector2
+		sample_pixel(int x, int y, const unsigned int index) const override;
+	};
+} // namespace poly::sampler
+#endif // !BLUE_NOISE_HPP
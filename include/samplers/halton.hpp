@@ -0,0 +1,27 @@
+#pragma once
+
+#ifndef HALTON_HPP
+#define HALTON_HPP
+
+#include "samplers/sampler.hpp"
+
+namespace poly::sampler
+{
+	/*
+	 * Halton sequence in bases 2 and 3, shifted per pixel (Cranley-Patterson
+	 * rotation) so that neighbouring pixels do not repeat the same pattern.
+	 */
+	class AA_Halton : public Sampler
+	{
+	public:
+		AA_Halton();
+
+		AA_Halton(unsigned int num_samp);
+
+		void generate_samples();
+
+		atlas::math::Vector2
+		sample_pixel(int x, int y, const unsigned int index) const override;
+	};
+} // namespace poly::sampler
+#endif // !HALTON_HPP
@@ -18,16 +18,6 @@ namespace poly::sampler
 		AA_Jittered(unsigned int num_samp, unsigned int num_set);
 
 		void generate_samples();
-
-		std::vector<float> sample_unit_square();
-
-		std::vector<float> sample_unit_square(const unsigned int index);
-
-		std::vector<float> sample_hemisphere();
-
-		std::vector<float> sample_hemisphere(const unsigned int index);
-		
-		void map_samples_to_hemisphere(const float e);
 	};
 } // namespace poly::sampler
 #endif // !JITTERED_HPP
\ No newline at end of file
@@ -2,35 +2,74 @@
 #ifndef SAMPLER_HPP
 #define SAMPLER_HPP
 
+#include <stdexcept>
 #include <vector>
+#include <atlas/math/math.hpp>
 
 namespace poly::sampler {
 
+    /*
+    * Supplies the sample positions within a pixel. Table based samplers keep
+    * their sets in flat arrays, sequence based ones compute each sample from
+    * the pixel and index. Samples are only read once generated, so any number
+    * of threads can share a sampler. A thread that wants the samples in
+    * sequence keeps its own Cursor.
+    */
     class Sampler {
     public:
         unsigned int granularity = 5000;
 
+        // Position of one thread in the sample sequence
+        struct Cursor {
+            unsigned int index = 0;
+        };
+
         Sampler() {
-          count = 0;
           num_samples = 1;
           num_sets = 1;
         }
-        ~Sampler() {}
+        virtual ~Sampler() {}
 
-        unsigned int get_num_samples() { return num_samples * num_sets; }
+        unsigned int get_num_samples() const { return num_samples * num_sets; }
         virtual void generate_samples() = 0;
-        virtual std::vector<float> sample_unit_square() = 0;
-        virtual std::vector<float> sample_unit_square(const unsigned int) = 0;
-        virtual std::vector<float> sample_hemisphere() = 0;
-        virtual std::vector<float> sample_hemisphere(const unsigned int) = 0;
-        virtual void map_samples_to_hemisphere(const float e) = 0;
+
+        // Sample index of pixel (x, y), in [0, 1)^2
+        virtual atlas::math::Vector2 sample_pixel(int x, int y, const unsigned int index) const {
+            (void)x;
+            (void)y;
+            if (samples.empty()) {
+                throw std::logic_error("sampler used before generate_samples");
+            }
+            return samples[index % samples.size()];
+        }
+
+        // Maps the first get_num_samples() samples onto a cosine power hemisphere
+        void map_samples_to_hemisphere(const float e);
+
+        atlas::math::Vector2 sample_unit_square(const unsigned int index) const {
+            return sample_pixel(0, 0, index);
+        }
+
+        atlas::math::Vector2 sample_unit_square(Cursor& cursor) const {
+            return sample_unit_square(cursor.index++);
+        }
+
+        atlas::math::Vector sample_hemisphere(const unsigned int index) const {
+            if (hemisphere_samples.empty()) {
+                throw std::logic_error("sampler used before map_samples_to_hemisphere");
+            }
+            return hemisphere_samples[index % hemisphere_samples.size()];
+        }
+
+        atlas::math::Vector sample_hemisphere(Cursor& cursor) const {
+            return sample_hemisphere(cursor.index++);
+        }
 
     protected:
         unsigned int num_samples;
         unsigned int num_sets;
-        unsigned int count;
-        std::vector<std::vector<float>> samples;
-        std::vector<std::vector<float>> hemisphere_samples;
+        std::vector<atlas::math::Vector2> samples;
+        std::vector<atlas::math::Vector> hemisphere_samples;
     };
 }
-#endif // !SAMPLER_HPP
\ No newline at end of file
+#endif // !SAMPLER_HPP
@@ -0,0 +1,28 @@
+#pragma once
+
+#ifndef SOBOL_HPP
+#define SOBOL_HPP
+
+#include "samplers/sampler.hpp"
+
+namespace poly::sampler
+{
+	/*
+	 * First two dimensions of the Sobol sequence with hash based Owen
+	 * scrambling. Every pixel gets its own scramble and index shuffle, and
+	 * any sample count is allowed. Nothing is stored.
+	 */
+	class AA_Sobol : public Sampler
+	{
+	public:
+		AA_Sobol();
+
+		AA_Sobol(unsigned int num_samp);
+
+		void generate_samples();
+
+		atlas::math::Vector2
+		sample_pixel(int x, int y, const unsigned int index) const override;
+	};
+} // namespace poly::sampler
+#endif // !SOBOL_HPP
@@ -82,7 +82,12 @@ namespace poly::structures
 
 		bool shadow_hit(const math::Ray<math::Vector>& ray, float& t) const;
 
-		std::vector<std::shared_ptr<poly::object::Object>>
+		void interaction_resolve(SurfaceInteraction& sr) const;
+
+		void append_primitives(std::vector<poly::object::Object const*>& primitives) const;
+
+		// Non-owning, the tree keeps the objects alive
+		std::vector<poly::object::Object*>
 		get_nearest_to_point(atlas::math::Point const& hitpoint,
 							 float radius_to_check,
 							 std::size_t max_num_points =
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef FRAMEBUFFER_HPP
+#define FRAMEBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <atlas/math/math.hpp>
+
+namespace poly::structures
+{
+	/*
+	 * Contiguous image stored in square blocks, so that a slab's pixels sit
+	 * close together. Slabs never overlap, which lets every thread write its
+	 * own pixels without locking. The memory is left untouched until a block
+	 * is prepared, so its pages land on the NUMA node of the thread that
+	 * renders it. The storage is page aligned and a block spans whole 4 KiB
+	 * pages, so no page is shared by two blocks.
+	 */
+	class Framebuffer
+	{
+	public:
+		// 32 x 32 pixels of 12 bytes are exactly three pages
+		static constexpr int block_size = 32;
+
+		static constexpr std::size_t page_size = 4096;
+
+		Framebuffer(int width, int height);
+
+		// Clears the blocks overlapping [x0, x1) x [y0, y1) that no thread
+		// has touched yet, must be called before writing to them
+		void prepare(int x0, int y0, int x1, int y1);
+
+		// (x, y) with y = 0 as the top row of the image
+		void set(int x, int y, atlas::math::Vector const& colour)
+		{
+			m_pixels[index(x, y)] = colour;
+		}
+
+		atlas::math::Vector const& get(int x, int y) const
+		{
+			return m_pixels[index(x, y)];
+		}
+
+		// Writes the image out row by row, top row first. Blocks that were
+		// never prepared come out black
+		void resolve(std::vector<atlas::math::Vector>& image) const;
+
+		int width() const;
+		int height() const;
+
+	private:
+		int m_width;
+		int m_height;
+		int m_blocks_x;
+
+		struct PageDeleter
+		{
+			void operator()(atlas::math::Vector* pixels) const;
+		};
+		std::unique_ptr<atlas::math::Vector[], PageDeleter> m_pixels;
+
+		// Per block: 0 untouched, 1 being cleared, 2 ready
+		std::unique_ptr<std::atomic<int>[]> m_block_state;
+
+		std::size_t block_count() const;
+
+		std::size_t index(int x, int y) const
+		{
+			std::size_t block = static_cast<std::size_t>(
+				(y / block_size) * m_blocks_x + (x / block_size));
+			return block * block_size * block_size +
+				   static_cast<std::size_t>((y % block_size) * block_size +
+											(x % block_size));
+		}
+	};
+} // namespace poly::structures
+
+#endif // !FRAMEBUFFER_HPP
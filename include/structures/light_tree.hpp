@@ -0,0 +1,72 @@
+#pragma once
+#ifndef LIGHT_TREE_HPP
+#define LIGHT_TREE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <atlas/math/math.hpp>
+#include "structures/bounds.hpp"
+#include "utilities/random.hpp"
+
+namespace poly::light { class Light; }
+
+namespace poly::structures
+{
+	// A light to shade from, weight scales its radiance to keep the sum
+	// unbiased when only some of the lights are picked
+	struct LightSample {
+		std::uint32_t light;
+		float weight;
+	};
+
+	/*
+	 * Binary tree over the lights that have a position, each node holding
+	 * the bounds and total power of the lights below it. A light is picked
+	 * by walking down from the root, choosing each child by how much light
+	 * it may send to the shading point, so the cost per shading point
+	 * grows with the depth of the tree instead of the number of lights.
+	 * Lights without a position are kept aside and always shaded.
+	 */
+	class LightTree
+	{
+	public:
+		LightTree(std::vector<std::shared_ptr<poly::light::Light>> const& lights);
+
+		// Lights to shade point from: every light outside the tree, plus
+		// count picks from the tree. Lights picked twice are merged
+		void sample(atlas::math::Point const& point,
+					unsigned int count,
+					poly::utils::Random& rng,
+					std::vector<LightSample>& samples) const;
+
+		// Picks a light of the tree by power alone, u in [0, 1). Increasing
+		// u walks the lights in tree order, so stratified u stay stratified
+		std::uint32_t sample_power(float u, float& pdf) const;
+
+		// Number of lights in the tree
+		std::size_t size() const;
+
+	private:
+		struct Node {
+			Bounds3D bounds;
+			float power;
+			// Leaves hold a light, interior nodes their second child, the
+			// first child always follows its parent
+			std::uint32_t light;
+			std::uint32_t second_child;
+			bool leaf;
+		};
+
+		std::vector<Node> m_nodes;
+		std::vector<std::uint32_t> m_unplaced;
+
+		std::uint32_t build(std::vector<std::shared_ptr<poly::light::Light>> const& lights,
+							std::vector<std::uint32_t>& order,
+							std::size_t first,
+							std::size_t last);
+		float importance(Node const& node, atlas::math::Point const& point) const;
+	};
+} // namespace poly::structures
+
+#endif // !LIGHT_TREE_HPP
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef PROJECTION_MAP_HPP
+#define PROJECTION_MAP_HPP
+
+#include <memory>
+#include <vector>
+#include <atlas/math/math.hpp>
+#include "structures/KDTree.hpp"
+#include "utilities/random.hpp"
+
+namespace poly::structures
+{
+	/*
+	 * Directions seen from a light, split into cells of equal solid angle
+	 * (uniform in cos(theta) and phi). Cells that may reach reflective or
+	 * transparent geometry are marked so that photons can be aimed at them.
+	 */
+	class ProjectionMap
+	{
+	public:
+		ProjectionMap(atlas::math::Point const& origin,
+					  std::vector<std::shared_ptr<poly::object::Object>> const&
+						  scene,
+					  int theta_cells = 64,
+					  int phi_cells	  = 128);
+
+		// Fraction of the sphere covered by marked cells
+		float coverage() const;
+
+		// Uniform direction within a random marked/unmarked cell
+		atlas::math::Vector sample_marked(poly::utils::Random& rng) const;
+		atlas::math::Vector sample_unmarked(poly::utils::Random& rng) const;
+
+	private:
+		int m_theta_cells;
+		int m_phi_cells;
+		std::vector<bool> m_marked;
+		std::vector<int> m_marked_cells;
+		std::vector<int> m_unmarked_cells;
+
+		void mark(atlas::math::Point const& origin, Bounds3D const& bounds);
+		atlas::math::Vector sample_cell(int cell, poly::utils::Random& rng) const;
+	};
+} // namespace poly::structures
+
+#endif // !PROJECTION_MAP_HPP
@@ -1,27 +1,32 @@
 #pragma once
 
 #include <vector>
-#include <mutex>
 #include <memory>
+#include "structures/framebuffer.hpp"
 #include "structures/world.hpp"
 #include "structures/view_plane.hpp"
+#include "structures/visibility_buffer.hpp"
 
 namespace poly::structures {
 
     class scene_slab {
     public:
-        std::shared_ptr<World> world;
-        std::shared_ptr<std::mutex> storage_mutex;
-        std::shared_ptr<std::vector<std::vector<atlas::math::Vector>>> storage;
+        // Read-only, shared by every slab of a render
+        World const* world;
+        std::shared_ptr<Framebuffer> framebuffer;
+        // Samples taken per pixel, only kept by adaptive renders
+        std::shared_ptr<Framebuffer> sample_counts;
+        // Primitives that may be seen in the slab, only binned by hybrid
+        // renders
+        std::vector<BinnedPrimitive> primitives;
         int start_x;
         int end_x;
         int start_y;
         int end_y;
 
         scene_slab(
-          std::shared_ptr<World> _world,
-          std::shared_ptr<std::mutex> _storage_mutex,
-          std::shared_ptr<std::vector<std::vector<atlas::math::Vector>>> _storage,
+          World const* _world,
+          std::shared_ptr<Framebuffer> _framebuffer,
           int _start_x,
           int _end_x,
           int _start_y,
@@ -32,7 +37,6 @@ namespace poly::structures {
         int start_x, int end_x,
         int start_y, int end_y,
         std::size_t preferred_slab_size,
-        std::shared_ptr<poly::structures::World> world,
-        std::shared_ptr<std::mutex> storage_mutex,
-        std::shared_ptr<std::vector<std::vector<atlas::math::Vector>>> storage);
+        poly::structures::World const* world,
+        std::shared_ptr<Framebuffer> framebuffer);
 }
\ No newline at end of file
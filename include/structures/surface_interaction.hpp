@@ -7,6 +7,7 @@
 #include "materials/material.hpp"
 
 namespace poly::material { class Material; }
+namespace poly::object { class Object; }
 
 using Colour = atlas::math::Vector;
 
@@ -17,8 +18,15 @@ namespace poly::structures {
 		float m_u, m_v;
 		unsigned int depth;
 		atlas::math::Ray<atlas::math::Vector> m_ray;
-		std::shared_ptr<poly::material::Material> m_material;
+		// Owned by the hit object, never outlives the scene
+		poly::material::Material const* m_material;
+		// Closest primitive so far and where on it, see Object::interaction_resolve
+		poly::object::Object const* m_object;
+		float m_beta, m_gamma;
 		Colour m_colour;
+		// Weight of this hit in the pixel, the product of the reflectances
+		// along the path from the camera
+		Colour m_throughput;
 		atlas::math::Normal m_normal;
 
 		SurfaceInteraction();
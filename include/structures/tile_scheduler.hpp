@@ -0,0 +1,74 @@
+#pragma once
+#ifndef TILE_SCHEDULER_HPP
+#define TILE_SCHEDULER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "structures/scene_slab.hpp"
+
+namespace poly::structures
+{
+	/*
+	 * Hands out slabs to a fixed set of workers. Slabs are ordered along a
+	 * Morton curve and dealt to the workers in contiguous runs. A worker takes
+	 * from the front of its own deque and, once empty, steals from the back
+	 * of another's, trying workers on its own NUMA node first. Once fewer
+	 * slabs are queued than there are workers, the slabs handed out are split
+	 * into quarters so that every thread finishes at about the same time.
+	 */
+	class TileScheduler
+	{
+	public:
+		TileScheduler(std::vector<std::shared_ptr<scene_slab>> slabs,
+					  std::size_t num_workers,
+					  int min_slab_size = 8,
+					  std::vector<std::size_t> const& worker_nodes = {});
+
+		// Queue for a worker that just started, see the definition. No two
+		// calls get the same queue while there are free ones
+		std::size_t claim(std::size_t preferred, std::size_t node);
+
+		// Next slab for this worker, nullptr once every slab is taken
+		std::shared_ptr<scene_slab> next(std::size_t worker);
+
+		// Called by a worker once a slab is rendered
+		void complete();
+
+		// Slabs currently queued for a worker, front first
+		std::vector<std::shared_ptr<scene_slab>> queued(std::size_t worker);
+
+		std::size_t total() const;
+		std::size_t completed() const;
+
+	private:
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<std::shared_ptr<scene_slab>> slabs;
+		};
+
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		std::vector<std::vector<std::size_t>> m_victims;
+		std::vector<std::size_t> m_nodes;
+		std::vector<bool> m_claimed;
+		std::mutex m_claim_mutex;
+		int m_min_slab_size;
+		std::atomic<std::size_t> m_total;
+		std::atomic<std::size_t> m_remaining;
+		std::atomic<std::size_t> m_completed;
+
+		std::shared_ptr<scene_slab> pop_front(std::size_t worker);
+		std::shared_ptr<scene_slab> steal(std::size_t victim);
+		std::shared_ptr<scene_slab> split(std::size_t worker,
+										  std::shared_ptr<scene_slab> slab);
+	};
+
+	// Interleaves the bits of x and y (16 bits each)
+	std::uint32_t morton_code(std::uint32_t x, std::uint32_t y);
+} // namespace poly::structures
+
+#endif // !TILE_SCHEDULER_HPP
@@ -9,5 +9,13 @@ namespace poly::structures {
         int vres;
         int gamma;
         unsigned int max_depth;
+
+        // Rays whose path throughput falls below this are not traced
+        float min_contribution = 0.0f;
+        // Depth from which weak paths are ended by Russian roulette, 0 is off
+        unsigned int roulette_depth = 0;
+        // Lights picked per shading point from the light tree, 0 shades from
+        // every light
+        unsigned int light_samples = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef VISIBILITY_BUFFER_HPP
+#define VISIBILITY_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <atlas/math/math.hpp>
+
+namespace poly::object { class Object; }
+
+namespace poly::structures
+{
+	// A primitive binned to a slab, with the pixels [start_x, end_x) x
+	// [start_y, end_y) its screen bounds may cover
+	struct BinnedPrimitive {
+		poly::object::Object const* primitive;
+		int start_x;
+		int end_x;
+		int start_y;
+		int end_y;
+	};
+
+	/*
+	 * Closest primitive and its distance for every sample of a slab, found
+	 * by rasterising the primitives binned to it, plus the direction of the
+	 * sample's camera ray. Shading re-runs the hit test of the stored
+	 * primitive alone, so nothing else about the hit needs to be kept.
+	 * Samples are stored pixel by pixel, row by row from the slab's start_y.
+	 */
+	struct VisibilityBuffer {
+		std::vector<poly::object::Object const*> primitives;
+		std::vector<float> depths;
+		std::vector<atlas::math::Vector> directions;
+		unsigned int samples = 0;
+
+		// Empties pixels * samples entries, keeping the memory
+		void reset(std::size_t pixels, unsigned int samples_per_pixel);
+		std::size_t index(std::size_t pixel, unsigned int sample) const
+		{
+			return pixel * samples + sample;
+		}
+	};
+} // namespace poly::structures
+
+#endif // !VISIBILITY_BUFFER_HPP
@@ -4,6 +4,7 @@
 #include <memory>
 #include <vector>
 #include <atlas/math/math.hpp>
+#include <atlas/math/ray.hpp>
 
 namespace poly::light { class Light; }
 namespace poly::object { class Object; }
@@ -14,6 +15,9 @@ namespace poly::structures {
 
     class Tracer; // avoids non-declaration in circular dependancy
 	class ViewPlane;
+	class SurfaceInteraction;
+	class LightTree;
+	struct LightSample;
 
     class World {
     public:
@@ -34,6 +38,9 @@ namespace poly::structures {
         
         // Lights in our scene
         std::vector<std::shared_ptr<poly::light::Light>> m_lights; 
+
+        // Built from m_lights once they are parsed
+        std::shared_ptr<LightTree> m_light_tree;
         
         // Output as 1D array
         std::vector<atlas::math::Vector> m_image;
@@ -46,6 +53,22 @@ namespace poly::structures {
 
         // Dimensions of each slab
         unsigned int m_slab_size;
+
+        // Closest object along the ray, shading data is only resolved for it
+        bool closest_hit(atlas::math::Ray<atlas::math::Vector> const& ray,
+                         SurfaceInteraction& sr) const;
+        // Same, but only against objects, e.g. a tile's culled object list
+        bool closest_hit(atlas::math::Ray<atlas::math::Vector> const& ray,
+                         SurfaceInteraction& sr,
+                         std::vector<poly::object::Object const*> const& objects) const;
+
+        // True when shading picks m_vp->light_samples lights from the light
+        // tree instead of using every light
+        bool light_sampling() const;
+
+        // Lights to shade sr from, with the weight of each
+        void select_lights(SurfaceInteraction const& sr,
+                           std::vector<LightSample>& lights) const;
     };
 }
 
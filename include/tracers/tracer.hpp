@@ -15,7 +15,8 @@ namespace poly::structures {
 	class Tracer {
 	public:
 		Tracer(World& world);
-		virtual Colour trace_ray([[maybe_unused]] math::Ray<math::Vector> const& ray, World const& world,[[maybe_unused]] const unsigned int depth) const;
+		// throughput is the weight the ray's colour will have in the pixel
+		virtual Colour trace_ray([[maybe_unused]] math::Ray<math::Vector> const& ray, World const& world,[[maybe_unused]] const unsigned int depth, [[maybe_unused]] Colour const& throughput) const;
 
 	private:
 		World& m_world;
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef WAVEFRONTTRACER_HPP
+#define WAVEFRONTTRACER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <atlas/math/ray.hpp>
+#include "materials/material.hpp"
+#include "structures/world.hpp"
+#include "structures/surface_interaction.hpp"
+#include "structures/light_tree.hpp"
+
+namespace poly::structures {
+
+	// One wave of rays, stored as structure of arrays. pixels indexes the
+	// radiance buffer the light carried by each ray is added to
+	struct RayQueue {
+		std::vector<math::Vector> origins;
+		std::vector<math::Vector> directions;
+		std::vector<Colour> throughputs;
+		std::vector<std::uint32_t> pixels;
+		// Every ray of a wave is at the same depth
+		unsigned int depth = 0;
+
+		void push(math::Ray<math::Vector> const& ray, Colour const& throughput, std::uint32_t pixel);
+		void clear();
+		std::size_t size() const { return origins.size(); }
+	};
+
+	// Shadow rays of one wave, with the light they let through if unblocked
+	struct ShadowQueue {
+		std::vector<math::Vector> origins;
+		std::vector<math::Vector> directions;
+		std::vector<std::uint32_t> lights;
+		std::vector<Colour> contributions;
+		std::vector<std::uint32_t> pixels;
+
+		void push(math::Ray<math::Vector> const& ray, std::uint32_t light, Colour const& contribution, std::uint32_t pixel);
+		void clear();
+		std::size_t size() const { return origins.size(); }
+	};
+
+	/*
+	* Breadth-first alternative to the Whitted tracer. Rays are traced a
+	* wave at a time: the whole wave is intersected, the hits are sorted by
+	* material and shaded a material at a time, then the shadow rays they
+	* emitted are traced as one batch per light and the reflected and refracted
+	* rays form the next wave, which is sorted by direction octant and
+	* origin cell so that neighbouring rays walk the same KD-tree nodes.
+	* Shading uses the same material and pruning
+	* code as the Whitted tracer, so both give the same image.
+	*/
+	class WavefrontTracer {
+	public:
+		// Sorting only pays off where rays walk a KD-tree, e.g. meshes
+		WavefrontTracer(World const& world, bool sort_secondary = true);
+
+		// Traces rays and every wave they spawn, adding the light they
+		// carry into radiance. rays is left empty. If given, the first wave
+		// is only tested against camera_objects
+		void trace(RayQueue& rays, std::vector<Colour>& radiance, std::vector<poly::object::Object const*> const* camera_objects = nullptr);
+
+	private:
+		World const& m_world;
+		bool m_sort_secondary;
+
+		// Reused between waves
+		RayQueue m_next;
+		ShadowQueue m_shadows;
+		std::vector<SurfaceInteraction> m_hits;
+		std::vector<std::uint32_t> m_hit_pixels;
+		std::vector<std::uint32_t> m_order;
+		std::vector<poly::material::ScatteredRay> m_scattered;
+		std::vector<std::pair<std::uint64_t, std::uint32_t>> m_keys;
+		RayQueue m_sorted;
+		std::vector<math::Ray<math::Vector>> m_batch;
+		std::vector<bool> m_blocked;
+		std::vector<std::uint32_t> m_shadow_order;
+		std::vector<std::uint32_t> m_light_starts;
+		std::vector<std::uint32_t> m_light_ends;
+		std::vector<LightSample> m_light_samples;
+
+		void sort_rays(RayQueue& rays);
+
+		void intersect(RayQueue const& rays, std::vector<Colour>& radiance, std::vector<poly::object::Object const*> const* objects);
+		void shade(std::vector<Colour>& radiance);
+		void trace_shadows(std::vector<Colour>& radiance);
+	};
+}
+
+#endif // !WAVEFRONTTRACER_HPP
@@ -13,8 +13,13 @@ namespace poly::structures {
 	{
 		public:
 		WhittedTracer(poly::structures::World& world);
-		Colour trace_ray(math::Ray<math::Vector> const& ray, World const& world, const unsigned int depth) const;
+		Colour trace_ray(math::Ray<math::Vector> const& ray, World const& world, const unsigned int depth, Colour const& throughput) const;
     };
+
+	// Probability that a ray is traced given the depth limit, contribution
+	// threshold and Russian roulette, 0 if it is dropped. Callers weight the
+	// light of surviving rays by its inverse
+	float path_survival(math::Ray<math::Vector> const& ray, World const& world, const unsigned int depth, Colour const& throughput);
 }
 
 #endif // !WHITTEDTRACER_HPP
\ No newline at end of file
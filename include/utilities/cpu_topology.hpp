@@ -0,0 +1,36 @@
+#pragma once
+#ifndef CPU_TOPOLOGY_HPP
+#define CPU_TOPOLOGY_HPP
+
+#include <string>
+#include <vector>
+
+namespace poly::utils
+{
+	/*
+	 * The logical CPUs this process may run on, grouped by NUMA node, and
+	 * the CPU quota of its cgroup. Detected once and shared by the program.
+	 */
+	struct CpuTopology
+	{
+		std::vector<int> cpus;			// usable CPUs, sorted by node
+		std::vector<std::size_t> nodes; // NUMA node of each entry in cpus
+		std::size_t quota_cores;		// cgroup limit, 0 if unlimited
+	};
+
+	CpuTopology const& cpu_topology();
+
+	// Cores this process can actually keep busy (affinity and cgroup quota)
+	std::size_t available_cores();
+
+	// Restricts the calling thread to one CPU, false if unsupported
+	bool pin_current_thread(int cpu);
+
+	// Parses kernel CPU lists such as "0-3,8,10-11"
+	std::vector<int> parse_cpu_list(std::string const& list);
+
+	// Whole cores a cgroup quota allows per period, 0 if unlimited
+	std::size_t quota_to_cores(double quota, double period);
+} // namespace poly::utils
+
+#endif // !CPU_TOPOLOGY_HPP
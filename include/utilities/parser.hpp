@@ -50,6 +50,22 @@ namespace poly::utils
 	 */
 	void create_world(nlohmann::json& task, poly::structures::World& w);
 
+	/*
+	 * Decides how many threads the render may use from max_threads and the
+	 * cores available to the process
+	 */
+	std::size_t thread_count(nlohmann::json& json);
+
+	/*
+	 * Reads whether worker threads should be pinned to cores
+	 */
+	bool pin_threads(nlohmann::json& json);
+
+	/*
+	 * Reads the seed for the random streams, the time if none is given
+	 */
+	std::uint64_t parse_seed(nlohmann::json& json);
+
 	/*
 	 * Parses camera from json data and returns a camera object
 	 */
@@ -0,0 +1,57 @@
+#pragma once
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+#include <cstdint>
+#include <initializer_list>
+
+namespace poly::utils
+{
+	// Separates the streams of subsystems that would otherwise share keys
+	enum class RandomDomain : std::uint64_t
+	{
+		camera = 1,
+		visible_point,
+		photon,
+		sampler,
+		colour,
+		roulette,
+		light
+	};
+
+	/*
+	 * PCG32 generator whose stream is picked by hashing a key (for example
+	 * pixel, sample and iteration) with the global seed. Every path owns its
+	 * generator, so threads never share state and a render does not depend
+	 * on how the work was scheduled.
+	 */
+	class Random
+	{
+	public:
+		Random(RandomDomain domain, std::initializer_list<std::uint64_t> key);
+
+		std::uint32_t next();
+
+		// Uniform in [0, 1)
+		float uniform();
+
+		// Uniform in [0, bound)
+		std::uint32_t uniform(std::uint32_t bound);
+
+	private:
+		std::uint64_t m_state;
+		std::uint64_t m_increment;
+	};
+
+	// Must be set before any generator is created, 0 by default
+	void set_random_seed(std::uint64_t seed);
+	std::uint64_t random_seed();
+
+	// SplitMix64 finaliser, a cheap well-mixed 64 bit hash
+	std::uint64_t mix_bits(std::uint64_t value);
+
+	// Key made from the bits of some floats, e.g. a ray or a hit point
+	std::uint64_t float_key(std::initializer_list<float> values);
+} // namespace poly::utils
+
+#endif // !RANDOM_HPP
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef STOP_SIGNAL_HPP
+#define STOP_SIGNAL_HPP
+
+namespace poly::utils
+{
+	/*
+	 * Process-wide request to stop rendering early. Renderers poll it between
+	 * units of work and return with the image they have so far, so main can
+	 * still write it out. Set from a SIGTERM handler or directly.
+	 */
+
+	// Routes SIGTERM to request_stop. A second SIGTERM kills the process as
+	// usual, in case the render is stuck
+	void install_stop_handler();
+
+	void request_stop();
+	bool stop_requested();
+} // namespace poly::utils
+
+#endif // !STOP_SIGNAL_HPP
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace poly::utils
+{
+	/*
+	 * Process-wide pool of worker threads, sized once at startup. Work is
+	 * either submitted as single tasks (with a future for the result) or
+	 * split with parallel_for, where the calling thread helps out. Since the
+	 * caller never blocks on work it could run itself, parallel_for may be
+	 * nested inside pool tasks.
+	 */
+	class ThreadPool
+	{
+	public:
+		ThreadPool(std::size_t num_threads, bool pin_threads = false);
+		~ThreadPool();
+
+		ThreadPool(ThreadPool const&) = delete;
+		ThreadPool& operator=(ThreadPool const&) = delete;
+
+		// Creates the shared pool, later calls keep the first size
+		static void initialize(std::size_t num_threads,
+							   bool pin_threads = false);
+		static ThreadPool& instance();
+
+		// Index of the calling pool thread, npos on any other thread
+		static std::size_t current_worker();
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+		std::size_t size() const;
+
+		// NUMA node a worker runs on, all 0 unless the threads are pinned
+		std::vector<std::size_t> const& worker_nodes() const;
+
+		template<typename F>
+		std::future<std::invoke_result_t<F>> submit(F&& task)
+		{
+			using Result = std::invoke_result_t<F>;
+			auto packaged = std::make_shared<std::packaged_task<Result()>>(
+				std::forward<F>(task));
+			std::future<Result> result = packaged->get_future();
+			enqueue([packaged]() { (*packaged)(); });
+			return result;
+		}
+
+		// Runs body(i) for every i in [0, count), returns once all are done
+		void parallel_for(std::size_t count,
+						  std::function<void(std::size_t)> const& body,
+						  std::size_t max_workers = 0);
+
+	private:
+		std::vector<std::thread> m_workers;
+		std::vector<std::size_t> m_worker_nodes;
+		std::deque<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		bool m_stopping;
+
+		void enqueue(std::function<void()> task);
+		void work(std::size_t index, int cpu);
+	};
+} // namespace poly::utils
+
+#endif // !THREAD_POOL_HPP
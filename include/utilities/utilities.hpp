@@ -26,10 +26,16 @@ namespace poly::utils {
 
 	void saveToBMP(std::string const& filename, poly::utils::BMP_info const& w);
 	void saveToBMP(nlohmann::json const& json, poly::utils::BMP_info const& w);
+	void save_accumulator(std::string const& filename,
+						  std::vector<Colour> const& storage,
+						  int width,
+						  int height,
+						  std::size_t num_iterations);
 
 	Colour random_colour_generate();
 	Colour colour_validate(Colour const& colour);
 	Colour colour_average_max(Colour const& colour);
+	float colour_luminance(Colour const& colour);
 	atlas::math::Vector reflect_over_normal(const atlas::math::Vector& wi, const atlas::math::Normal n);
 
 }
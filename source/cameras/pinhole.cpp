@@ -1,11 +1,32 @@
 #include "cameras/pinhole.hpp"
 #include "samplers/sampler.hpp"
 #include "structures/surface_interaction.hpp"
+#include "structures/tile_scheduler.hpp"
+#include "tracers/wavefront_tracer.hpp"
+#include "utilities/stop_signal.hpp"
+#include "utilities/thread_pool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
-#include <thread>
+#include <future>
+#include <limits>
+#include <string>
 
 namespace poly::camera
 {
+	// Rays per wave of the wavefront tracer
+	static constexpr std::size_t wave_size = 1 << 14;
+
+	// Bounds wider than this (planes) are kept for every tile
+	static constexpr float max_culled_extent = 1.0e6f;
+
+	// Tiles are culled as if this many pixels wider on each side, so that
+	// rounding never drops an object seen on the edge
+	static constexpr float tile_margin = 0.5f;
+
 	PinholeCamera::PinholeCamera() : m_d{}
 	{}
 	PinholeCamera::PinholeCamera(float d)
@@ -25,24 +46,53 @@ namespace poly::camera
 		}
 	}
 
-	void PinholeCamera::multithread_render_scene(poly::structures::World &world,
-												 poly::utils::BMP_info &output)
+	void PinholeCamera::adaptive_set(AdaptiveSampling const &adaptive)
 	{
-		int total_render_height = output.m_total_height;
-		int total_render_width	= output.m_total_width;
-		std::size_t num_threads = m_max_threads;
+		m_adaptive = adaptive;
+	}
 
-		std::shared_ptr<std::vector<std::vector<Colour>>> storage =
-			std::make_shared<std::vector<std::vector<Colour>>>(
-				world.m_vp->vres, std::vector<Colour>(world.m_vp->hres));
+	void PinholeCamera::progressive_set(ProgressiveRendering const &progressive)
+	{
+		m_progressive = progressive;
+	}
 
-		std::shared_ptr<std::mutex> storage_mutex =
-			std::make_shared<std::mutex>();
+	bool PinholeCamera::progressive() const
+	{
+		return m_progressive.enabled;
+	}
 
-		std::vector<std::thread> thread_list;
+	void PinholeCamera::wavefront_set(bool wavefront, bool sort_secondary)
+	{
+		m_wavefront		 = wavefront;
+		m_sort_secondary = sort_secondary;
+	}
 
-		std::shared_ptr<poly::structures::World> world_ptr =
-			std::make_shared<poly::structures::World>(world);
+	void PinholeCamera::hybrid_set(bool hybrid)
+	{
+		m_hybrid = hybrid;
+	}
+
+	void PinholeCamera::multithread_render_scene(
+		poly::structures::World const &world, poly::utils::BMP_info &output)
+	{
+		int total_render_height = output.m_total_height;
+		int total_render_width	= output.m_total_width;
+		poly::utils::ThreadPool& pool = poly::utils::ThreadPool::instance();
+		std::size_t num_threads =
+			std::max<std::size_t>(std::min(m_max_threads, pool.size()), 1);
+
+		// Every slab writes its own pixels, no lock is needed
+		std::shared_ptr<poly::structures::Framebuffer> framebuffer =
+			std::make_shared<poly::structures::Framebuffer>(world.m_vp->hres,
+															world.m_vp->vres);
+
+		// Adaptive renders record how many samples each pixel took, progressive
+		// ones need the count to average their running sums
+		std::shared_ptr<poly::structures::Framebuffer> sample_counts;
+		if (m_adaptive.max_samples > 0 || m_progressive.enabled) {
+			sample_counts = std::make_shared<poly::structures::Framebuffer>(
+				world.m_vp->hres, world.m_vp->vres);
+		}
 
 		int slab_width	= world.m_slab_size;
 		int slab_height = world.m_slab_size;
@@ -71,76 +121,296 @@ namespace poly::camera
 
 				std::shared_ptr<poly::structures::scene_slab> new_ti =
 					std::make_shared<poly::structures::scene_slab>(
-						world_ptr, // std::make_shared<World>(world),
-						storage_mutex,
-						storage,
+						&world,
+						framebuffer,
 						j - w_center,
 						j + slab_width - w_center,
 						i - h_center,
 						i + slab_height - h_center);
 
 				// Add this slab to our pool
+				new_ti->sample_counts = sample_counts;
 				slabs.push_back(new_ti);
 			}
 		}
 
-		// mutex protecting the list of slabs to be rendered
-		std::shared_ptr<std::mutex> slablist_mutex =
-			std::make_shared<std::mutex>();
+		// Hybrid renders rasterise each slab's first hits, so the primitives
+		// are sorted into the slabs up front. Adaptive slabs trace instead,
+		// as their pixels take different numbers of samples
+		bool rasterised =
+			m_progressive.enabled || m_adaptive.max_samples == 0;
+		if (m_hybrid && !m_wavefront && rasterised) {
+			bin_primitives(slabs);
+		}
+
+		if (m_progressive.enabled) {
+			progressive_render(slabs, num_threads, output);
+			return;
+		}
 
-		// Create the specified number of threads and let them work on the pool
-		// of slabs
 		std::clog << "INFO: rendering on " << num_threads << " threads"
 				  << std::endl;
+		float tail_idle = render_slabs(
+			slabs,
+			num_threads,
+			[this](std::shared_ptr<poly::structures::scene_slab> const &slab) {
+				if (m_wavefront) {
+					this->wavefront_slab(slab);
+				}
+				else {
+					this->render_slab(slab);
+				}
+			},
+			"");
+		std::clog << std::endl
+				  << "INFO: " << slabs.size() << " slabs rendered, tail idle "
+				  << tail_idle << "s over " << num_threads << " threads"
+				  << std::endl;
+
+		// Single pass from the blocked layout into the output image
+		framebuffer->resolve(output.m_image);
+
+		if (sample_counts) {
+			poly::utils::BMP_info counts = output;
+			sample_counts->resolve(counts.m_image);
+
+			// Counts are stored as a fraction of the maximum
+			double total_samples{0.0};
+			std::size_t pixels{0};
+			for (int row{output.m_total_height - output.m_end_height};
+				 row < output.m_total_height - output.m_start_height;
+				 ++row) {
+				for (int col{output.m_start_width}; col < output.m_end_width;
+					 ++col) {
+					total_samples +=
+						counts.m_image[static_cast<std::size_t>(
+										   row * output.m_total_width + col)]
+							.x *
+						m_adaptive.max_samples;
+					++pixels;
+				}
+			}
+			std::clog << "INFO: adaptive sampling took "
+					  << total_samples / std::max<std::size_t>(pixels, 1)
+					  << " samples per pixel on average" << std::endl;
+
+			if (!m_adaptive.sample_count_file.empty()) {
+				poly::utils::saveToBMP(m_adaptive.sample_count_file, counts);
+			}
+		}
+	}
+
+	/**
+	Renders a set of slabs on the thread pool. Each pool thread gets its own
+	queue of slabs and steals from the others once it runs dry, so the
+	workers only meet when the load is uneven
+
+	@param slabs the slabs to render
+	@param num_threads the number of workers to render with
+	@param render called once per slab, after its framebuffer blocks are
+	prepared
+	@param progress prefix for the progress line, e.g. the current pass
+
+	@returns the total time the workers spent waiting for the slowest one, in
+	seconds
+	*/
+	float PinholeCamera::render_slabs(
+		std::vector<std::shared_ptr<poly::structures::scene_slab>> const &slabs,
+		std::size_t num_threads,
+		std::function<void(std::shared_ptr<poly::structures::scene_slab> const &)>
+			const &render,
+		std::string const &progress) const
+	{
+		poly::utils::ThreadPool &pool = poly::utils::ThreadPool::instance();
+
+		// Queue i starts out meant for pool thread i and takes its NUMA node
+		std::vector<std::size_t> worker_nodes(
+			pool.worker_nodes().begin(),
+			pool.worker_nodes().begin() +
+				static_cast<std::ptrdiff_t>(num_threads));
+		poly::structures::TileScheduler scheduler(
+			slabs, num_threads, 8, worker_nodes);
+
+		// Set once the last worker runs out of slabs
+		std::mutex done_mutex;
+		std::condition_variable done_cv;
+		std::size_t finished_threads{0};
+
+		// When each thread ran out of slabs, to report the tail-idle time
+		std::vector<std::chrono::steady_clock::time_point> finish_times(
+			num_threads);
+
+		// Hand one worker per pool thread the scheduler, they take slabs until
+		// none are left
+		std::vector<std::future<void>> workers;
 		for (std::size_t i = 0; i < num_threads; i++) {
-			thread_list.push_back(std::thread(
-				[this, slablist_mutex, &slabs] 
-				{
-					std::shared_ptr<poly::structures::scene_slab> slab_ptr =
-						nullptr;
-					const size_t full_size = slabs.size();
-					while (true) {
-						// sanity check scope for the mutex
-						{ 
-							// Lock the slablist mutex
-							const std::lock_guard<std::mutex> lock(*slablist_mutex);
-
-							// If the slablist is empty, we can idle the thread	
-							if (slabs.empty()) {
-								return;
-							}
-
-							// Get the back of the queue
-							slab_ptr = slabs.back();
-							slabs.pop_back();
-
-							// Log to output
-							std::cout
-							<< "\r                                         ";
-							std::cout << "\rLOADING: "
-									  << ((float)slabs.size() * 100.0f / full_size)
-									  << "% to go. " << slabs.size()
-									  << " slabs left";
-							std::cout << std::flush;
-						}
+			workers.push_back(pool.submit([this,
+										   i,
+										   &pool,
+										   &render,
+										   &scheduler,
+										   &done_mutex,
+										   &done_cv,
+										   &finished_threads,
+										   &finish_times] {
+				// Whichever pool thread runs this task takes a queue on its
+				// own node, so the first touch below lands there
+				std::size_t thread = poly::utils::ThreadPool::current_worker();
+				std::size_t worker = scheduler.claim(
+					thread,
+					thread < pool.size() ? pool.worker_nodes()[thread] : 0);
 
-						// Render the slab
-						this->render_slab(slab_ptr);
-					}
-				}));
+				// First touch the framebuffer blocks of the slabs dealt to
+				// this worker, so they are allocated on its node
+				for (auto const &slab_ptr : scheduler.queued(worker)) {
+					this->prepare_slab(slab_ptr);
+				}
+
+				while (std::shared_ptr<poly::structures::scene_slab> slab_ptr =
+						   scheduler.next(worker)) {
+					// Render the slab
+					this->prepare_slab(slab_ptr);
+					render(slab_ptr);
+					scheduler.complete();
+				}
+
+				const std::lock_guard<std::mutex> lock(done_mutex);
+				finish_times[i] = std::chrono::steady_clock::now();
+				++finished_threads;
+				done_cv.notify_one();
+			}));
 		}
 
-		// Join all the threads
-		for (std::thread& thread : thread_list) {
-			if (thread.joinable()) {
-				thread.join();
+		// Progress is reported from here so that the workers never touch the
+		// console
+		{
+			std::unique_lock<std::mutex> lock(done_mutex);
+			while (!done_cv.wait_for(
+				lock, std::chrono::milliseconds(250), [&finished_threads, num_threads] {
+					return finished_threads == num_threads;
+				})) {
+				std::size_t left = scheduler.total() - scheduler.completed();
+				std::cout << "\r                                         ";
+				std::cout << "\rLOADING: " << progress
+						  << ((float)left * 100.0f / scheduler.total())
+						  << "% to go. " << left << " slabs left";
+				std::cout << std::flush;
 			}
 		}
 
-		// reformat the 2D vector into a single dimensional array
-		for (auto row : *(storage)) {
-			for (auto el : row) {
-				output.m_image.push_back(el);
+		for (std::future<void> &worker : workers) {
+			worker.get();
+		}
+
+		// Time the threads spent waiting for the slowest one to finish
+		auto last_finish =
+			*std::max_element(finish_times.begin(), finish_times.end());
+		std::chrono::duration<float> tail_idle{0.0f};
+		for (auto const &finish : finish_times) {
+			tail_idle += last_finish - finish;
+		}
+		return tail_idle.count();
+	}
+
+	/**
+	Renders the frame in passes over every slab, each pass adding
+	samples_per_pass samples to the running sum of every pixel. The deadline
+	and stop requests are checked before each slab, so a stop takes effect
+	within one slab's worth of work. A pass that is cut short leaves pixels
+	with different sample counts, which is why every pixel keeps its own
+
+	@param slabs the slabs covering the frame, holding the sums in their
+	framebuffer and the counts in sample_counts
+	@param num_threads the number of workers to render with
+	@param output the image to write the averages to
+	*/
+	void PinholeCamera::progressive_render(
+		std::vector<std::shared_ptr<poly::structures::scene_slab>> const &slabs,
+		std::size_t num_threads,
+		poly::utils::BMP_info &output) const
+	{
+		if (slabs.empty()) {
+			return;
+		}
+
+		std::chrono::steady_clock::time_point start =
+			std::chrono::steady_clock::now();
+		auto out_of_time = [this, start]() {
+			return m_progressive.time_budget > 0.0f &&
+				   std::chrono::duration<float>(
+					   std::chrono::steady_clock::now() - start)
+						   .count() > m_progressive.time_budget;
+		};
+
+		poly::structures::World const &world = *(slabs.front()->world);
+		unsigned int total_samples = world.m_sampler->get_num_samples();
+		unsigned int per_pass = std::max(m_progressive.samples_per_pass, 1u);
+		unsigned int num_passes = (total_samples + per_pass - 1) / per_pass;
+
+		std::clog << "INFO: rendering progressively on " << num_threads
+				  << " threads, " << num_passes << " passes of " << per_pass
+				  << " samples";
+		if (m_progressive.time_budget > 0.0f) {
+			std::clog << " within " << m_progressive.time_budget << "s";
+		}
+		std::clog << std::endl;
+
+		// Set by the first slab that sees the deadline or a stop request, the
+		// rest of the pass is skipped
+		std::atomic<bool> stopped{false};
+		unsigned int passes_done{0};
+		for (unsigned int pass{0}; pass < num_passes && !stopped; ++pass) {
+			unsigned int first_sample = pass * per_pass;
+			unsigned int num_samples =
+				std::min(per_pass, total_samples - first_sample);
+
+			render_slabs(
+				slabs,
+				num_threads,
+				[this, &stopped, &out_of_time, first_sample, num_samples](
+					std::shared_ptr<poly::structures::scene_slab> const &slab) {
+					// The first pass always completes, so that every pixel
+					// has at least one sample
+					if (first_sample > 0 &&
+						(stopped || poly::utils::stop_requested() ||
+						 out_of_time())) {
+						stopped = true;
+						return;
+					}
+					this->accumulate_slab(slab, first_sample, num_samples);
+				},
+				"pass " + std::to_string(pass + 1) + " of " +
+					std::to_string(num_passes) + ", ");
+
+			if (!stopped) {
+				++passes_done;
+				if (poly::utils::stop_requested() || out_of_time()) {
+					stopped = passes_done < num_passes;
+				}
+			}
+		}
+
+		std::clog << std::endl;
+		if (stopped) {
+			std::clog << "INFO: "
+					  << (poly::utils::stop_requested() ? "stop requested"
+														: "time budget reached")
+					  << " after " << passes_done << " of " << num_passes
+					  << " passes" << std::endl;
+		}
+		else {
+			std::clog << "INFO: " << num_passes << " passes rendered"
+					  << std::endl;
+		}
+
+		// Average whatever each pixel has taken so far
+		std::vector<Colour> counts;
+		slabs.front()->sample_counts->resolve(counts);
+		slabs.front()->framebuffer->resolve(output.m_image);
+		for (std::size_t pixel{0}; pixel < output.m_image.size(); ++pixel) {
+			if (counts[pixel].x > 0.0f) {
+				output.m_image[pixel] = colour_validate(
+					output.m_image[pixel] * (1.0f / counts[pixel].x));
 			}
 		}
 	}
@@ -149,6 +419,7 @@ namespace poly::camera
 	{
 		int wheight = (int)world.m_vp->vres;
 		int wwidth	= (int)world.m_vp->hres;
+		poly::sampler::Sampler::Cursor cursor;
 
 		for (int i = (wheight / 2) - 1; i >= -(wheight / 2); i--) {
 			for (int j = -(wwidth / 2); j < (wwidth / 2); j++) {
@@ -165,23 +436,20 @@ namespace poly::camera
 						poly::structures::SurfaceInteraction();
 					sr.m_colour = world.m_background;
 
-					std::vector<float> sample =
-						world.m_sampler->sample_unit_square();
+					math::Vector2 sample =
+						world.m_sampler->sample_unit_square(cursor);
 
 					atlas::math::Vector x =
-						m_u * ((float)j + (float)sample.at(0));
+						m_u * ((float)j + sample.x);
 					atlas::math::Vector y =
-						m_v * ((float)i + (float)sample.at(1));
+						m_v * ((float)i + sample.y);
 					atlas::math::Vector z = -m_w * (float)m_d;
 
 					atlas::math::Vector direction = glm::normalize((x + y + z));
 
 					atlas::math::Ray<atlas::math::Vector> ray(m_eye, direction);
 
-					for (std::shared_ptr<poly::object::Object> obj :
-						 world.m_scene) {
-						obj->hit(ray, sr);
-					}
+					world.closest_hit(ray, sr);
 
 					if (sr.m_material) {
 						average += sr.m_material->shade(sr, world);
@@ -203,98 +471,639 @@ namespace poly::camera
 	void PinholeCamera::render_slab(
 		std::shared_ptr<poly::structures::scene_slab> slab) const
 	{
-		poly::structures::World world			  = *(slab->world);
-		std::shared_ptr<std::mutex> storage_mutex = slab->storage_mutex;
-		std::shared_ptr<std::vector<std::vector<Colour>>> storage =
-			slab->storage;
+		poly::structures::World const &world	   = *(slab->world);
+		poly::structures::Framebuffer &framebuffer = *(slab->framebuffer);
 
 		int start_x = slab->start_x;
 		int end_x	= slab->end_x;
 		int start_y = slab->start_y;
 		int end_y	= slab->end_y;
 
-		std::vector<std::vector<Colour>> temp_storage =
-			std::vector<std::vector<Colour>>(
-				world.m_slab_size, std::vector<Colour>(world.m_slab_size));
+		// Without adaptive sampling every pixel takes the sampler's count
+		bool adaptive = m_adaptive.max_samples > 0;
+		unsigned int min_samples =
+			adaptive ? std::max(m_adaptive.min_samples, 1u)
+					 : world.m_sampler->get_num_samples();
+		unsigned int max_samples =
+			adaptive ? std::max(m_adaptive.max_samples, min_samples)
+					 : min_samples;
+
+		// Rasterised first hits need every pixel to take the same samples
+		bool rasterised = m_hybrid && !adaptive;
+		poly::structures::VisibilityBuffer visibility;
+		std::vector<poly::object::Object const *> objects;
+		if (rasterised) {
+			rasterize_slab(slab, 0, max_samples, visibility);
+		}
+		else {
+			objects = tile_objects(slab);
+		}
 
+		std::size_t pixel{0};
 		for (int i = start_y; i < end_y; i++) {
-			for (int j = start_x; j < end_x; j++) {
-				Colour average		= Colour(0.0f, 0.0f, 0.0f);
-				unsigned int count	= 0;
-				int max_num_samples = world.m_sampler->get_num_samples();
+			for (int j = start_x; j < end_x; j++, pixel++) {
+				Colour average = Colour(0.0f, 0.0f, 0.0f);
+				unsigned int count{0};
+
+				// Welford's running mean and variance of the luminance
+				float mean{0.0f};
+				float squared_deviations{0.0f};
 
 				// For anti-aliasing
-				for (int s = 0; s < max_num_samples; s++) {
-					poly::structures::SurfaceInteraction sr;
-					sr.m_colour = world.m_background;
-					sr.depth	= 0;
+				while (count < max_samples) {
+					Colour colour =
+						rasterised
+							? shade_visible(visibility,
+											visibility.index(pixel, count),
+											world)
+							: trace_sample(i, j, count, world, objects);
+					average += colour;
+					++count;
+
+					float luminance = poly::utils::colour_luminance(colour);
+					float delta		= luminance - mean;
+					mean += delta / (float)count;
+					squared_deviations += delta * (luminance - mean);
+
+					// Stop once the mean is known well enough
+					if (count >= min_samples && count > 1 &&
+						std::sqrt(squared_deviations / (float)(count - 1) /
+								  (float)count) <= m_adaptive.threshold) {
+						break;
+					}
+				}
 
-					// Get the sample offsets [0, 1)
-					std::vector<float> sample =
-						world.m_sampler->sample_unit_square(s);
+				//// 0,0 is in the center of the screen
+				int row = (int)i + (int)(world.m_vp->vres / 2);
+				int col = (int)j + (int)(world.m_vp->hres / 2);
 
-					math::Vector x = m_u * ((float)j + (float)sample.at(0));
-					math::Vector y = m_v * ((float)i + (float)sample.at(1));
-					math::Vector z = -m_w * (float)m_d;
+				// Write straight to the final storage location
+				framebuffer.set(col,
+								world.m_vp->vres - row - 1,
+								colour_validate(average * (1 / (float)count)));
+				if (slab->sample_counts) {
+					float fraction = (float)count / (float)max_samples;
+					slab->sample_counts->set(
+						col,
+						world.m_vp->vres - row - 1,
+						Colour(fraction, fraction, fraction));
+				}
+			}
+		}
+	}
 
-					math::Vector direction = glm::normalize((x + y + z));
+	/**
+	Adds samples [first_sample, first_sample + num_samples) of every pixel in
+	a slab to the running sums, used by progressive renders
 
-					math::Ray<math::Vector> ray(m_eye, direction);
+	@param slab the slab to render, its framebuffer holds the sums and its
+	sample_counts the samples taken so far
+	@param first_sample the first sample number of this pass
+	@param num_samples the samples to take per pixel
+	*/
+	void PinholeCamera::accumulate_slab(
+		std::shared_ptr<poly::structures::scene_slab> const &slab,
+		unsigned int first_sample,
+		unsigned int num_samples) const
+	{
+		poly::structures::World const &world = *(slab->world);
+		poly::structures::Framebuffer &sums	  = *(slab->framebuffer);
+		poly::structures::Framebuffer &counts = *(slab->sample_counts);
 
-					bool hit = false;
-					for (std::shared_ptr<poly::object::Object> obj :
-						 world.m_scene) {
-						if (obj->hit(ray, sr)) {
-							hit = true;
-						}
-					}
+		std::vector<Colour> wavefront;
+		poly::structures::VisibilityBuffer visibility;
+		std::vector<poly::object::Object const *> objects;
+		if (m_wavefront) {
+			wavefront = wavefront_samples(slab, first_sample, num_samples);
+		}
+		else if (m_hybrid) {
+			rasterize_slab(slab, first_sample, num_samples, visibility);
+		}
+		else {
+			objects = tile_objects(slab);
+		}
 
-					// If we hit an object, it will have set the material
-					if (hit && sr.m_material) {
-						average += sr.m_material->shade(sr, world);
+		std::size_t pixel{0};
+		for (int i = slab->start_y; i < slab->end_y; i++) {
+			for (int j = slab->start_x; j < slab->end_x; j++, pixel++) {
+				int row = (int)i + (int)(world.m_vp->vres / 2);
+				int col = (int)j + (int)(world.m_vp->hres / 2);
+				int y	= world.m_vp->vres - row - 1;
+
+				Colour sum = sums.get(col, y);
+				if (m_wavefront) {
+					sum += wavefront[pixel];
+				}
+				else if (m_hybrid) {
+					for (unsigned int s{0}; s < num_samples; ++s) {
+						sum += shade_visible(
+							visibility, visibility.index(pixel, s), world);
 					}
-					else {
-						average += sr.m_colour;
+				}
+				else {
+					for (unsigned int s{first_sample};
+						 s < first_sample + num_samples;
+						 ++s) {
+						sum += trace_sample(i, j, s, world, objects);
 					}
-					count++;
 				}
+				sums.set(col, y, sum);
+				counts.set(col,
+						   y,
+						   counts.get(col, y) + Colour((float)num_samples));
+			}
+		}
+	}
 
-				int row_0_indexed = (int)i - start_y;
-				int col_0_indexed = (int)j - start_x;
+	/**
+	Creates the camera ray of one sample
 
-				temp_storage.at(row_0_indexed).at(col_0_indexed) =
-					colour_validate(average * (1 / (float)count));
+	@param i the row, 0 being the centre of the image
+	@param j the column, 0 being the centre of the image
+	@param s the sample number within the pixel
+	@param world the world holding the sampler
+
+	@returns the ray from the eye through the sample
+	*/
+	math::Ray<math::Vector>
+	PinholeCamera::sample_ray(int i,
+							  int j,
+							  unsigned int s,
+							  poly::structures::World const &world) const
+	{
+		// Get the sample offsets [0, 1)
+		math::Vector2 sample = world.m_sampler->sample_pixel(j, i, s);
+
+		math::Vector x = m_u * ((float)j + sample.x);
+		math::Vector y = m_v * ((float)i + sample.y);
+		math::Vector z = -m_w * (float)m_d;
+
+		math::Vector direction = glm::normalize((x + y + z));
+
+		return math::Ray<math::Vector>(m_eye, direction);
+	}
+
+	/**
+	Traces samples [first_sample, first_sample + num_samples) of every pixel
+	in a slab with the wavefront tracer. Whole samples of the slab are put in
+	a wave until it holds about wave_size rays, so the queues stay small for
+	large slabs and high sample counts
+
+	@param slab the slab to render
+	@param first_sample the first sample number
+	@param num_samples the samples to take per pixel
+
+	@returns the sum of the samples of each pixel, row by row from start_y
+	*/
+	std::vector<Colour> PinholeCamera::wavefront_samples(
+		std::shared_ptr<poly::structures::scene_slab> const &slab,
+		unsigned int first_sample,
+		unsigned int num_samples) const
+	{
+		poly::structures::World const &world = *(slab->world);
+		int width  = slab->end_x - slab->start_x;
+		int height = slab->end_y - slab->start_y;
+		std::size_t pixels =
+			static_cast<std::size_t>(std::max(width, 0) * std::max(height, 0));
+
+		std::vector<Colour> radiance(pixels, Colour(0.0f, 0.0f, 0.0f));
+		if (pixels == 0) {
+			return radiance;
+		}
+
+		unsigned int samples_per_wave = static_cast<unsigned int>(
+			std::max<std::size_t>(wave_size / pixels, 1));
+
+		poly::structures::WavefrontTracer tracer(world, m_sort_secondary);
+		poly::structures::RayQueue rays;
+		std::vector<poly::object::Object const *> objects = tile_objects(slab);
+		for (unsigned int s{first_sample}; s < first_sample + num_samples;
+			 s += samples_per_wave) {
+			unsigned int last =
+				std::min(s + samples_per_wave, first_sample + num_samples);
+
+			rays.clear();
+			rays.depth = 0;
+			for (unsigned int sample{s}; sample < last; ++sample) {
+				std::uint32_t pixel{0};
+				for (int i = slab->start_y; i < slab->end_y; i++) {
+					for (int j = slab->start_x; j < slab->end_x; j++, pixel++) {
+						rays.push(sample_ray(i, j, sample, world),
+								  Colour(1.0f, 1.0f, 1.0f),
+								  pixel);
+					}
+				}
 			}
+			tracer.trace(rays, radiance, &objects);
 		}
-		
-		// Place the slab in the final image
-		for (int i = start_y; i < end_y; i++) {
-			const std::lock_guard<std::mutex> lock(*storage_mutex);
-			for (int j = start_x; j < end_x; j++) {
-				//// 0,0 is in the center of the screen
+		return radiance;
+	}
+
+	/**
+	Renders a slab with the wavefront tracer, taking the sampler's count for
+	every pixel
+
+	@param slab the slab to render
+	*/
+	void PinholeCamera::wavefront_slab(
+		std::shared_ptr<poly::structures::scene_slab> const &slab) const
+	{
+		poly::structures::World const &world	   = *(slab->world);
+		poly::structures::Framebuffer &framebuffer = *(slab->framebuffer);
+		unsigned int num_samples = world.m_sampler->get_num_samples();
+
+		std::vector<Colour> sums = wavefront_samples(slab, 0, num_samples);
+
+		std::size_t pixel{0};
+		for (int i = slab->start_y; i < slab->end_y; i++) {
+			for (int j = slab->start_x; j < slab->end_x; j++, pixel++) {
 				int row = (int)i + (int)(world.m_vp->vres / 2);
 				int col = (int)j + (int)(world.m_vp->hres / 2);
 
-				// Align the temp slab with the overall scene
-				int row_0_indexed = (int)i - start_y;
-				int col_0_indexed = (int)j - start_x;
+				framebuffer.set(
+					col,
+					world.m_vp->vres - row - 1,
+					colour_validate(sums[pixel] * (1 / (float)num_samples)));
+			}
+		}
+	}
+
+	/**
+	Traces one camera sample through the scene
 
-				// Copy out info to the final storage location
-				storage->at(world.m_vp->vres - row - 1).at(col) =
-					temp_storage.at(row_0_indexed).at(col_0_indexed);
+	@param i the row, 0 being the centre of the image
+	@param j the column, 0 being the centre of the image
+	@param s the sample number within the pixel
+	@param world the world to render
+	@param objects the objects the slab of the pixel may see
+
+	@returns the colour seen by the sample
+	*/
+	Colour PinholeCamera::trace_sample(
+		int i,
+		int j,
+		unsigned int s,
+		poly::structures::World const &world,
+		std::vector<poly::object::Object const *> const &objects) const
+	{
+		poly::structures::SurfaceInteraction sr;
+		sr.m_colour = world.m_background;
+		sr.depth	= 0;
+
+		math::Ray<math::Vector> ray = sample_ray(i, j, s, world);
+
+		bool hit = world.closest_hit(ray, sr, objects);
+
+		// If we hit an object, it will have set the material
+		if (hit && sr.m_material) {
+			return sr.m_material->shade(sr, world);
+		}
+		return sr.m_colour;
+	}
+
+	/**
+	Culls the scene against the frustum of a slab: the four planes through
+	the eye and the slab's edges on the view plane, and the plane of the eye
+	facing forward. An object is dropped when its bounds lie wholly outside
+	one of them. Objects with unbounded extent, e.g. planes, are always kept
+
+	@param slab the slab whose camera rays the list is for
+
+	@returns the objects that camera rays of the slab may hit
+	*/
+	std::vector<poly::object::Object const *> PinholeCamera::tile_objects(
+		std::shared_ptr<poly::structures::scene_slab> const &slab) const
+	{
+		poly::structures::World const &world = *(slab->world);
+
+		// Sample offsets are in [0, 1), so the slab's rays pass between its
+		// start and end lines on the view plane
+		float x0 = (float)slab->start_x - tile_margin;
+		float x1 = (float)slab->end_x + tile_margin;
+		float y0 = (float)slab->start_y - tile_margin;
+		float y1 = (float)slab->end_y + tile_margin;
+		math::Vector z = -m_w * (float)m_d;
+		math::Vector corners[4] = {m_u * x0 + m_v * y0 + z,
+								   m_u * x1 + m_v * y0 + z,
+								   m_u * x1 + m_v * y1 + z,
+								   m_u * x0 + m_v * y1 + z};
+		math::Vector centre = corners[0] + corners[1] + corners[2] + corners[3];
+
+		// Inward facing normals of the frustum planes
+		math::Vector normals[5];
+		for (int edge{0}; edge < 4; ++edge) {
+			normals[edge] = glm::cross(corners[edge], corners[(edge + 1) % 4]);
+			if (glm::dot(normals[edge], centre) < 0.0f) {
+				normals[edge] = -normals[edge];
+			}
+		}
+		normals[4] = -m_w;
+
+		std::vector<poly::object::Object const *> objects;
+		for (auto const &object : world.m_scene) {
+			poly::structures::Bounds3D bounds = object->get_boundbox();
+			math::Vector size				  = bounds.diagonal();
+			if (!(size.x < max_culled_extent && size.y < max_culled_extent &&
+				  size.z < max_culled_extent)) {
+				objects.push_back(object.get());
+				continue;
 			}
+
+			// The corner furthest along a normal decides whether the box is
+			// wholly behind that plane
+			bool outside{false};
+			for (math::Vector const &normal : normals) {
+				math::Vector furthest(
+					normal.x >= 0.0f ? bounds.pMax.x : bounds.pMin.x,
+					normal.y >= 0.0f ? bounds.pMax.y : bounds.pMin.y,
+					normal.z >= 0.0f ? bounds.pMax.z : bounds.pMin.z);
+				if (glm::dot(normal, furthest - m_eye) < 0.0f) {
+					outside = true;
+					break;
+				}
+			}
+			if (!outside) {
+				objects.push_back(object.get());
+			}
+		}
+		return objects;
+	}
+
+	/**
+	Projects a point onto the view plane, in the units of the pixel grid: a
+	camera ray through (x, y) passes through the point
+
+	@param point the point to project
+	@param screen set to the point's position on the view plane
+
+	@returns false if the point is not in front of the eye
+	*/
+	bool PinholeCamera::project(math::Point const &point,
+								math::Vector2 &screen) const
+	{
+		math::Vector offset = point - m_eye;
+		float depth			= -glm::dot(offset, m_w);
+		if (depth <= 0.0f) {
+			return false;
 		}
+		screen = math::Vector2(m_d * glm::dot(offset, m_u) / depth,
+							   m_d * glm::dot(offset, m_v) / depth);
+		return true;
 	}
 
-	math::Ray<atlas::math::Vector> PinholeCamera::get_ray(
-		int i, int j, poly::structures::World const &world) const
+	/**
+	Sorts the primitives of the scene into the slabs their projected bounds
+	overlap. Meshes are split into their triangles. Primitives partly behind
+	the eye, or unbounded like planes, are binned to every slab
+
+	@param slabs the slabs of the render, in rows of world.m_slab_size
+	*/
+	void PinholeCamera::bin_primitives(
+		std::vector<std::shared_ptr<poly::structures::scene_slab>> const &slabs)
+		const
+	{
+		if (slabs.empty()) {
+			return;
+		}
+		poly::structures::World const &world = *(slabs.front()->world);
+
+		// The pixels covered by the slabs, and how the slabs are laid out
+		int image_x0 = slabs.front()->start_x;
+		int image_y0 = slabs.front()->start_y;
+		int image_x1 = image_x0;
+		int image_y1 = image_y0;
+		std::size_t columns{0};
+		for (auto const &slab : slabs) {
+			image_x1 = std::max(image_x1, slab->end_x);
+			image_y1 = std::max(image_y1, slab->end_y);
+			if (slab->start_y == image_y0) {
+				++columns;
+			}
+			slab->primitives.clear();
+		}
+		int slab_size = std::max((int)world.m_slab_size, 1);
+
+		std::vector<poly::object::Object const *> primitives;
+		for (auto const &object : world.m_scene) {
+			object->append_primitives(primitives);
+		}
+
+		std::size_t binned{0};
+		for (poly::object::Object const *primitive : primitives) {
+			poly::structures::Bounds3D bounds = primitive->get_boundbox();
+			math::Vector size				  = bounds.diagonal();
+
+			int x0 = image_x0;
+			int x1 = image_x1;
+			int y0 = image_y0;
+			int y1 = image_y1;
+			if (size.x < max_culled_extent && size.y < max_culled_extent &&
+				size.z < max_culled_extent) {
+				math::Vector2 lower(std::numeric_limits<float>::max());
+				math::Vector2 upper(std::numeric_limits<float>::lowest());
+				int in_front{0};
+				for (int corner{0}; corner < 8; ++corner) {
+					math::Point point((corner & 1) ? bounds.pMax.x : bounds.pMin.x,
+									  (corner & 2) ? bounds.pMax.y : bounds.pMin.y,
+									  (corner & 4) ? bounds.pMax.z : bounds.pMin.z);
+					math::Vector2 screen;
+					if (project(point, screen)) {
+						lower = glm::min(lower, screen);
+						upper = glm::max(upper, screen);
+						++in_front;
+					}
+				}
+
+				// Camera rays only reach forward
+				if (in_front == 0) {
+					continue;
+				}
+
+				// Widened by a pixel, so that rounding never drops a sample.
+				// Clamped to the image first, as points near the eye project far away
+				// and out of range of an int
+				if (in_front == 8) {
+					float const left = (float)image_x0, right = (float)image_x1;
+					float const top = (float)image_y0, bottom = (float)image_y1;
+					x0 = std::max(x0, (int)std::floor(std::clamp(lower.x, left, right)) - 1);
+					x1 = std::min(x1, (int)std::floor(std::clamp(upper.x, left, right)) + 2);
+					y0 = std::max(y0, (int)std::floor(std::clamp(lower.y, top, bottom)) - 1);
+					y1 = std::min(y1, (int)std::floor(std::clamp(upper.y, top, bottom)) + 2);
+				}
+			}
+			if (x0 >= x1 || y0 >= y1) {
+				continue;
+			}
+
+			// Only the slabs in the rows and columns the bounds span
+			std::size_t first_row	 = (std::size_t)((y0 - image_y0) / slab_size);
+			std::size_t last_row	 = (std::size_t)((y1 - 1 - image_y0) / slab_size);
+			std::size_t first_column = (std::size_t)((x0 - image_x0) / slab_size);
+			std::size_t last_column	 = std::min(
+				 (std::size_t)((x1 - 1 - image_x0) / slab_size), columns - 1);
+			for (std::size_t row{first_row}; row <= last_row; ++row) {
+				for (std::size_t column{first_column}; column <= last_column;
+					 ++column) {
+					std::size_t index = row * columns + column;
+					if (index >= slabs.size()) {
+						break;
+					}
+					poly::structures::scene_slab &slab = *slabs[index];
+					if (x0 < slab.end_x && slab.start_x < x1 &&
+						y0 < slab.end_y && slab.start_y < y1) {
+						slab.primitives.push_back({primitive, x0, x1, y0, y1});
+						++binned;
+					}
+				}
+			}
+		}
+
+		std::clog << "INFO: rasterising first hits of " << primitives.size()
+				  << " primitives, " << (float)binned / (float)slabs.size()
+				  << " per slab on average" << std::endl;
+	}
+
+	/**
+	Finds the first hit of samples [first_sample, first_sample + num_samples)
+	of every pixel in a slab. Each binned primitive is tested against the
+	camera rays of the samples inside its screen bounds only, keeping the
+	closest hit of each sample, so no acceleration structure is walked
+
+	@param slab the slab to rasterise, its primitives binned
+	@param first_sample the first sample number
+	@param num_samples the samples to take per pixel
+	@param visibility filled with the closest primitive of every sample
+	*/
+	void PinholeCamera::rasterize_slab(
+		std::shared_ptr<poly::structures::scene_slab> const &slab,
+		unsigned int first_sample,
+		unsigned int num_samples,
+		poly::structures::VisibilityBuffer &visibility) const
+	{
+		poly::structures::World const &world = *(slab->world);
+		int width  = std::max(slab->end_x - slab->start_x, 0);
+		int height = std::max(slab->end_y - slab->start_y, 0);
+		visibility.reset(static_cast<std::size_t>(width * height), num_samples);
+
+		std::size_t index{0};
+		for (int i = slab->start_y; i < slab->end_y; i++) {
+			for (int j = slab->start_x; j < slab->end_x; j++) {
+				for (unsigned int s{0}; s < num_samples; ++s) {
+					visibility.directions[index++] =
+						sample_ray(i, j, first_sample + s, world).d;
+				}
+			}
+		}
+
+		// Only records the closest hit, as in World::closest_hit
+		poly::structures::SurfaceInteraction probe;
+		for (poly::structures::BinnedPrimitive const &binned :
+			 slab->primitives) {
+			int x0 = std::max(binned.start_x, slab->start_x);
+			int x1 = std::min(binned.end_x, slab->end_x);
+			int y0 = std::max(binned.start_y, slab->start_y);
+			int y1 = std::min(binned.end_y, slab->end_y);
+
+			for (int i = y0; i < y1; i++) {
+				for (int j = x0; j < x1; j++) {
+					std::size_t pixel = static_cast<std::size_t>(
+						(i - slab->start_y) * width + (j - slab->start_x));
+					for (unsigned int s{0}; s < num_samples; ++s) {
+						std::size_t sample = visibility.index(pixel, s);
+						probe.m_tmin	   = visibility.depths[sample];
+						probe.m_object	   = nullptr;
+						binned.primitive->hit(
+							math::Ray<math::Vector>(
+								m_eye, visibility.directions[sample]),
+							probe);
+						if (probe.m_object) {
+							visibility.depths[sample]	  = probe.m_tmin;
+							visibility.primitives[sample] = probe.m_object;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	Shades one sample of a rasterised slab. The stored primitive is hit
+	again to recover the details of the hit, then shading and any secondary
+	rays go on as for a traced camera ray
+
+	@param visibility the rasterised slab
+	@param index the sample's entry in visibility
+	@param world the world to render
+
+	@returns the colour seen by the sample
+	*/
+	Colour PinholeCamera::shade_visible(
+		poly::structures::VisibilityBuffer const &visibility,
+		std::size_t index,
+		poly::structures::World const &world) const
+	{
+		poly::structures::SurfaceInteraction sr;
+		sr.m_colour = world.m_background;
+		sr.depth	= 0;
+
+		poly::object::Object const *primitive = visibility.primitives[index];
+		if (primitive) {
+			math::Ray<math::Vector> ray(m_eye, visibility.directions[index]);
+			primitive->hit(ray, sr);
+			sr.m_ray = ray;
+			primitive->interaction_resolve(sr);
+			if (sr.m_material) {
+				return sr.m_material->shade(sr, world);
+			}
+		}
+		return sr.m_colour;
+	}
+
+	/**
+	Prepares the framebuffer blocks a slab will write to
+
+	@param slab the slab about to be rendered
+	*/
+	void PinholeCamera::prepare_slab(
+		std::shared_ptr<poly::structures::scene_slab> const &slab) const
+	{
+		poly::structures::World const &world = *(slab->world);
+		int half_width	= (int)(world.m_vp->hres / 2);
+		int half_height = (int)(world.m_vp->vres / 2);
+
+		// Rows are flipped on the way in, see render_slab
+		int x0 = slab->start_x + half_width;
+		int y0 = world.m_vp->vres - (slab->end_y + half_height);
+		int x1 = slab->end_x + half_width;
+		int y1 = world.m_vp->vres - (slab->start_y + half_height);
+		slab->framebuffer->prepare(x0, y0, x1, y1);
+		if (slab->sample_counts) {
+			slab->sample_counts->prepare(x0, y0, x1, y1);
+		}
+	}
+
+	/**
+	Creates a ray through pixel (i, j) using one of the sampler's offsets
+
+	@param i the row, 0 being the centre of the image
+	@param j the column, 0 being the centre of the image
+	@param world the world holding the sampler
+	@param rng the generator of the calling path, picks the offset
+
+	@returns the camera ray
+	*/
+	math::Ray<atlas::math::Vector>
+	PinholeCamera::get_ray(int i,
+						   int j,
+						   poly::structures::World const &world,
+						   poly::utils::Random &rng) const
 	{
-		std::size_t num_samples = world.m_sampler->get_num_samples();
-		std::vector<float> sample =
-			world.m_sampler->sample_unit_square(rand() % num_samples);
+		unsigned int num_samples = world.m_sampler->get_num_samples();
+		math::Vector2 sample =
+			world.m_sampler->sample_pixel(j, i, rng.uniform(num_samples));
 
-		atlas::math::Vector x = m_u * ((float)j + (float)sample.at(0));
-		atlas::math::Vector y = m_v * ((float)i + (float)sample.at(1));
+		atlas::math::Vector x = m_u * ((float)j + sample.x);
+		atlas::math::Vector y = m_v * ((float)i + sample.y);
 		atlas::math::Vector z = -m_w * (float)m_d;
 
 		atlas::math::Vector direction = glm::normalize((x + y + z));
@@ -1,12 +1,19 @@
 #include "integrators/SPPMIntegrator.hpp"
 #include "samplers/sampler.hpp"
 #include "structures/world.hpp"
+#include "structures/light_tree.hpp"
+#include "utilities/random.hpp"
+#include "utilities/stop_signal.hpp"
+#include "utilities/thread_pool.hpp"
 #include "utilities/utilities.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
 #include <iostream>
-#include <thread>
 #include <vector>
 #include <atlas/math/random.hpp>
-#include <condition_variable>
+#include <zeus/timer.hpp>
 
 // static constexpr float direct_shading_strength		   = 0.5f;
 // static constexpr float photon_strength_multiplier	   = 100.0f;
@@ -19,43 +26,46 @@
 ===============================
 */
 
-void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
+void absorb_photon(poly::material::Material const *current_material,
 				   poly::structures::Photon &photon,
 				   poly::structures::KDTree &vp_tree,
 				   std::size_t max_depth,
 				   poly::structures::World const &world,
-				   std::shared_ptr<std::mutex> storage_mutex);
+				   poly::utils::Random &rng);
 
-void transmit_photon(std::shared_ptr<poly::material::Material> current_material,
+void transmit_photon(poly::material::Material const *current_material,
 					 poly::structures::Photon &photon,
 					 poly::structures::KDTree &vp_tree,
 					 std::size_t max_depth,
 					 poly::structures::World const &world,
 					 float colour_change,
-					 std::shared_ptr<std::mutex> storage_mutex);
+					 poly::utils::Random &rng);
 
-void bounce_photon(std::shared_ptr<poly::material::Material> current_material,
+void bounce_photon(poly::material::Material const *current_material,
 				   poly::structures::Photon &photon,
 				   poly::structures::KDTree &vp_tree,
 				   std::size_t max_depth,
 				   poly::structures::World const &world,
 				   float object_colour_intensity,
-				   std::shared_ptr<std::mutex> storage_mutex);
+				   poly::utils::Random &rng);
 
 void absorb_vp(poly::structures::SurfaceInteraction &sr,
 			   atlas::math::Ray<atlas::math::Vector> const &ray,
-			   std::shared_ptr<poly::structures::World> world,
-			   Colour &amount);
+			   poly::structures::World const &world,
+			   Colour &amount,
+			   poly::utils::Random &rng);
 
 void transmit_vp(poly::structures::SurfaceInteraction &sr,
 				 atlas::math::Ray<atlas::math::Vector> const &ray,
-				 std::shared_ptr<poly::structures::World> world,
-				 Colour &amount);
+				 poly::structures::World const &world,
+				 Colour &amount,
+				 poly::utils::Random &rng);
 
 void bounce_vp(poly::structures::SurfaceInteraction &sr,
 			   atlas::math::Ray<atlas::math::Vector> const &ray,
-			   std::shared_ptr<poly::structures::World> world,
-			   Colour &amount);
+			   poly::structures::World const &world,
+			   Colour &amount,
+			   poly::utils::Random &rng);
 
 namespace poly::integrators
 {
@@ -73,64 +83,105 @@ namespace poly::integrators
 		m_direct_shading_strength{direct_shading_strength_},
 		m_photon_strength_multiplier{photon_strength_multiplier_},
 		m_num_photons_per_iteration{num_photons_per_iteration_},
-		m_num_working_areas{num_working_areas_}
+		m_num_working_areas{num_working_areas_},
+		m_worker_index{0},
+		m_worker_count{1},
+		m_accumulator_file{},
+		m_target_error{0.0f},
+		m_time_budget{0.0f},
+		m_caustic_photon_fraction{0.5f},
+		m_projection_maps{}
 	{}
 
+	void SPPMIntegrator::set_worker(std::size_t worker_index,
+									std::size_t worker_count)
+	{
+		m_worker_count = std::max<std::size_t>(worker_count, 1);
+		m_worker_index = worker_index % m_worker_count;
+	}
+
+	void SPPMIntegrator::set_accumulator_file(std::string const &filename)
+	{
+		m_accumulator_file = filename;
+	}
+
+	void SPPMIntegrator::set_target_error(float target_error)
+	{
+		m_target_error = target_error;
+	}
+
+	void SPPMIntegrator::set_time_budget(float seconds)
+	{
+		m_time_budget = seconds;
+	}
+
+	void SPPMIntegrator::set_caustic_photon_fraction(float fraction)
+	{
+		m_caustic_photon_fraction = std::clamp(fraction, 0.0f, 1.0f);
+	}
+
 	void SPPMIntegrator::render(poly::structures::World const &world,
 								poly::camera::PinholeCamera const &camera,
 								poly::utils::BMP_info &output)
 	{
 		// First, create our list of slabs to render with
 		output.m_image.clear();
-		std::shared_ptr<std::vector<std::vector<Colour>>> storage =
-			std::make_shared<std::vector<std::vector<Colour>>>(
-				world.m_vp->vres, std::vector<Colour>(world.m_vp->hres));
-
-		std::vector<std::shared_ptr<std::vector<std::vector<Colour>>>>
-			storage_pool;
-
-		/*for (std::size_t iteration{0}; iteration < m_number_iterations;
-			 ++iteration) {
-			std::shared_ptr<std::vector<std::vector<Colour>>> temp =
-				std::make_shared<std::vector<std::vector<Colour>>>(
-					world.m_vp->vres, std::vector<Colour>(world.m_vp->hres));
-			temp_storage.push_back(temp);
-		}*/
-
-		for (std::size_t i{0}; i < m_num_working_areas; ++i) {
-			std::shared_ptr<std::vector<std::vector<Colour>>> temp =
-				std::make_shared<std::vector<std::vector<Colour>>>(
-					world.m_vp->vres, std::vector<Colour>(world.m_vp->hres));
-			storage_pool.push_back(temp);
-		}
-
-		std::shared_ptr<std::mutex> storage_mutex =
-			std::make_shared<std::mutex>();
 
-		std::shared_ptr<std::condition_variable> storage_cv =
-			std::make_shared<std::condition_variable>();
+		// One flat running sum for the whole frame. Iterations keep their
+		// contributions on their own visible points, so the memory needed
+		// per concurrent iteration does not depend on the resolution
+		AccumulationBuffer storage(world.m_vp->hres, world.m_vp->vres);
 
-		std::vector<std::thread> thread_list;
-		std::shared_ptr<poly::structures::World> world_ptr =
-			std::make_shared<poly::structures::World>(world);
+		// Random streams are keyed by iteration, and every worker renders
+		// different iterations, so their photons never repeat
+		if (m_worker_count > 1) {
+			std::clog << "INFO: SPPM worker " << m_worker_index + 1 << " of "
+					  << m_worker_count << std::endl;
+		}
 
-		// Repeat the illumination pass for num_iterations
-		for (std::size_t iteration{0}; iteration < m_number_iterations;
-			 ++iteration) {
-			// Create a new thread for each iteration
+		// The scene does not move between iterations, so the directions
+		// leading to specular objects only need to be found once per light
+		m_projection_maps.clear();
+		for (auto const &light : world.m_lights) {
+			m_projection_maps.emplace_back(light->location(), world.m_scene);
+			std::clog << "INFO: caustic directions cover "
+					  << 100.0f * m_projection_maps.back().coverage()
+					  << "% of light " << m_projection_maps.size() << std::endl;
+		}
 
-			thread_list.emplace_back(std::thread([=, &storage_pool]() {
-				// Fetch a storage location
-				std::shared_ptr<std::vector<std::vector<Colour>>> storage_ptr;
-				{
-					std::unique_lock lock(*storage_mutex);
+		// Convergence tracking shared by the iteration threads
+		zeus::Timer<float> render_timer;
+		render_timer.start();
+		std::atomic<bool> converged{false};
+		std::size_t iterations_done{0};
+
+		// Repeat the illumination pass for num_iterations, only taking the
+		// iterations that belong to this worker
+		std::vector<std::size_t> iterations;
+		for (std::size_t iteration{m_worker_index};
+			 iteration < m_number_iterations;
+			 iteration += m_worker_count) {
+			iterations.push_back(iteration);
+		}
 
-					while (storage_pool.empty()) {
-						storage_cv->wait(lock);
-					}
+		// Each lane runs one iteration at a time, so the lane count limits
+		// how many visible point lists are alive at the same time
+		std::mutex progress_mutex;
+		poly::utils::ThreadPool &pool = poly::utils::ThreadPool::instance();
+		pool.parallel_for(
+			iterations.size(),
+			[&](std::size_t index) {
+				std::size_t iteration = iterations[index];
+
+				// Skip the remaining iterations once a stopping criterion hit
+				if ((m_time_budget > 0.0f &&
+					 render_timer.elapsed() > m_time_budget) ||
+					poly::utils::stop_requested()) {
+					converged = true;
+				}
 
-					storage_ptr = storage_pool.back();
-					storage_pool.pop_back();
+				if (converged) {
+					return;
 				}
 
 				/* -------- FIRST PASS -------- */
@@ -141,61 +192,148 @@ namespace poly::integrators
 						world.m_start_height - (world.m_vp->vres / 2),
 						world.m_end_width - (world.m_vp->hres / 2),
 						world.m_end_height - (world.m_vp->vres / 2),
-						storage_ptr,
 						camera,
-						world_ptr);
+						world,
+						iteration);
 
 				/* -------- SECOND PASS -------- */
 				/* ------- PHOTON POINTS ------- */
-				photon_mapping(world, visible_points, storage_mutex);
-				std::clog << "INFO: iteration complete" << std::endl;
-
-				// Return the storage location to the queue
-
-				{
-					std::unique_lock lock(*storage_mutex);
-					for (std::size_t i{0};
-						 i < static_cast<std::size_t>(world.m_vp->vres);
-						 ++i) {
-						for (std::size_t j{0};
-							 j < static_cast<std::size_t>(world.m_vp->hres);
-							 ++j) {
-							storage->at(i).at(j) += storage_ptr->at(i).at(j);
-							storage_ptr->at(i).at(j) = static_cast<Colour>(0);
-						}
-					}
-					storage_pool.push_back(storage_ptr);
-					storage_cv->notify_all();
+				photon_mapping(world, visible_points, iteration);
+
+				// Fold the visible points into the running sum. Bands are
+				// locked one at a time, so iterations finishing together
+				// reduce into different bands in parallel
+				float change = storage.fold(visible_points);
+
+				std::unique_lock lock(progress_mutex);
+				++iterations_done;
+
+				std::clog << "INFO: iteration " << iterations_done
+						  << " complete after " << render_timer.elapsed()
+						  << "s";
+				if (iterations_done > 1) {
+					std::clog << ", mean relative change " << change;
 				}
-			}));
+				std::clog << std::endl;
+
+				if (m_target_error > 0.0f && iterations_done > 1 &&
+					change < m_target_error && !converged) {
+					std::clog << "INFO: reached target error of "
+							  << m_target_error << std::endl;
+					converged = true;
+				}
+			},
+			std::max<std::size_t>(m_num_working_areas, 1));
+
+		if (!m_accumulator_file.empty()) {
+			poly::utils::save_accumulator(m_accumulator_file,
+										  storage.sum(),
+										  storage.width(),
+										  storage.height(),
+										  iterations_done);
 		}
 
-		// Joining the threads
-		for (std::thread &t : thread_list) {
-			t.join();
+		// Photons are scaled by the full iteration count, so averaging over
+		// the iterations done here gives the same exposure as a full render
+		float scale_factor =
+			(1 / static_cast<float>(std::max<std::size_t>(iterations_done, 1)));
+
+		// The running sum is already laid out as the output image
+		output.m_image.reserve(storage.sum().size());
+		for (Colour const &element : storage.sum()) {
+			output.m_image.push_back(
+				poly::utils::colour_average_max(element * scale_factor));
 		}
+	}
+
+	/*
+	===============================
+	----- ACCUMULATION BUFFER -----
+	===============================
+	*/
 
-		// for (auto &iter : temp_storage) {
-		//	for (std::size_t i{0};
-		//		 i < static_cast<std::size_t>(world.m_vp->vres);
-		//		 ++i) {
-		//		for (std::size_t j{0};
-		//			 j < static_cast<std::size_t>(world.m_vp->hres);
-		//			 ++j) {
-		//			storage->at(i).at(j) += iter->at(i).at(j);
-		//		}
-		//	}
-		//}
-
-		float scale_factor = (1 / static_cast<float>(m_number_iterations));
-
-		// reformat the 2D vector into a single dimensional array
-		for (auto &row : *(storage)) {
-			for (auto element : row) {
-				output.m_image.push_back(
-					poly::utils::colour_average_max(element * scale_factor));
+	AccumulationBuffer::AccumulationBuffer(int width, int height) :
+		m_width{std::max(width, 0)},
+		m_height{std::max(height, 0)},
+		m_sum(static_cast<std::size_t>(m_width) * m_height),
+		m_band_mutexes((m_height + band_rows - 1) / band_rows),
+		m_band_merges(m_band_mutexes.size(), 0)
+	{}
+
+	/**
+	Adds the contributions of one iteration's visible points into the sum
+
+	@param visible_points the visible points of the finished iteration, in the
+	order create_visible_points produced them
+
+	@returns the mean relative change of the per pixel estimate (the sum
+	divided by the number of iterations) over the pixels that received a
+	visible point
+	*/
+	float AccumulationBuffer::fold(
+		std::vector<std::shared_ptr<poly::object::Object>> const
+			&visible_points)
+	{
+		// Bucket the points by band, keeping their original order
+		std::vector<std::vector<VisiblePoint const *>> bands(
+			m_band_mutexes.size());
+		for (auto const &object : visible_points) {
+			VisiblePoint const *vp =
+				static_cast<VisiblePoint const *>(object.get());
+			int row = m_height - (vp->index_y + m_height / 2) - 1;
+			int col = vp->index_x + m_width / 2;
+			if (row >= 0 && row < m_height && col >= 0 && col < m_width) {
+				bands[row / band_rows].push_back(vp);
 			}
 		}
+
+		double total_change{0.0};
+		std::size_t num_points{0};
+		for (std::size_t band{0}; band < bands.size(); ++band) {
+			const std::lock_guard<std::mutex> lock(m_band_mutexes[band]);
+
+			// Every band counts every iteration, even when no point landed
+			std::size_t merged = m_band_merges[band]++;
+			const float old_scale = 1.0f / std::max<float>(1.0f, merged);
+			const float new_scale = 1.0f / (merged + 1.0f);
+
+			for (VisiblePoint const *vp : bands[band]) {
+				int row = m_height - (vp->index_y + m_height / 2) - 1;
+				int col = vp->index_x + m_width / 2;
+				Colour &sum = m_sum[static_cast<std::size_t>(row) * m_width +
+									col];
+
+				float old_estimate =
+					poly::utils::colour_luminance(sum) * old_scale;
+				sum += vp->contribution;
+				float new_estimate =
+					poly::utils::colour_luminance(sum) * new_scale;
+
+				if (new_estimate > 0.0f) {
+					total_change +=
+						std::abs(new_estimate - old_estimate) / new_estimate;
+					++num_points;
+				}
+			}
+		}
+
+		return num_points == 0 ? 0.0f
+							   : static_cast<float>(total_change / num_points);
+	}
+
+	std::vector<Colour> const &AccumulationBuffer::sum() const
+	{
+		return m_sum;
+	}
+
+	int AccumulationBuffer::width() const
+	{
+		return m_width;
+	}
+
+	int AccumulationBuffer::height() const
+	{
+		return m_height;
 	}
 
 	std::vector<std::shared_ptr<poly::object::Object>>
@@ -204,66 +342,108 @@ namespace poly::integrators
 		int start_y,
 		int end_x,
 		int end_y,
-		std::shared_ptr<std::vector<std::vector<Colour>>> storage,
 		poly::camera::PinholeCamera const &camera,
-		std::shared_ptr<poly::structures::World> world)
+		poly::structures::World const &world,
+		std::size_t iteration)
 	{
-		int total_number_of_pixels = (end_x - start_x) * (end_y - start_y);
+		const int width	 = end_x - start_x;
+		const int height = end_y - start_y;
+		if (width <= 0 || height <= 0) {
+			return {};
+		}
 
-		// Create an array of visible points  placed in the KD tree)
-		std::vector<std::shared_ptr<poly::object::Object>> visiblePoints;
-		visiblePoints.reserve(total_number_of_pixels);
-
-		for (int i = start_y; i < end_y; i++) {
-			for (int j = start_x; j < end_x; j++) {
-				// Shoot a ray into the scene, closest intersection will become
-				// a "visible point"
-				poly::structures::SurfaceInteraction sr;
-				sr.m_colour = world->m_background;
-				sr.depth	= 0;
-				atlas::math::Ray<atlas::math::Vector> ray =
-					camera.get_ray(i, j, *world);
-
-				// Iterate over scene, tracking hitpoints
-				bool hit = false;
-				for (std::shared_ptr<poly::object::Object> obj :
-					 world->m_scene) {
-					if (obj->hit(ray, sr)) {
-						hit = true;
+		// One preallocated slot per pixel. Tiles only write their own slot
+		// range, so the layout does not depend on the number of threads
+		std::shared_ptr<std::vector<VisiblePoint>> slots =
+			std::make_shared<std::vector<VisiblePoint>>(
+				static_cast<std::size_t>(width) * height);
+
+		const int tiles_x	= (width + visible_point_tile_size - 1) /
+							visible_point_tile_size;
+		const int tiles_y	= (height + visible_point_tile_size - 1) /
+							visible_point_tile_size;
+		const int num_tiles = tiles_x * tiles_y;
+		std::atomic<int> next_tile{0};
+
+		auto trace_tiles = [&]() {
+			for (int tile = next_tile++; tile < num_tiles; tile = next_tile++) {
+				int tile_start_y =
+					start_y + (tile / tiles_x) * visible_point_tile_size;
+				int tile_start_x =
+					start_x + (tile % tiles_x) * visible_point_tile_size;
+				int tile_end_y =
+					std::min(tile_start_y + visible_point_tile_size, end_y);
+				int tile_end_x =
+					std::min(tile_start_x + visible_point_tile_size, end_x);
+
+				for (int i = tile_start_y; i < tile_end_y; i++) {
+					for (int j = tile_start_x; j < tile_end_x; j++) {
+						// Shoot a ray into the scene, closest intersection
+						// will become a "visible point"
+						poly::structures::SurfaceInteraction sr;
+						sr.m_colour = world.m_background;
+						sr.depth	= 0;
+
+						// One stream per pixel and iteration
+						poly::utils::Random rng{
+							poly::utils::RandomDomain::visible_point,
+							{static_cast<std::uint64_t>(i),
+							 static_cast<std::uint64_t>(j),
+							 iteration}};
+						atlas::math::Ray<atlas::math::Vector> ray =
+							camera.get_ray(i, j, world, rng);
+
+						// Iterate over scene, tracking hitpoints
+						bool hit = world.closest_hit(ray, sr);
+
+						// If we have hit an object, create a visible point at
+						// the surface interaction point
+						if (hit && sr.m_material) {
+							// Shade the point directly
+							Colour direct = sr.m_material->shade(sr, world);
+
+							Colour amount{1.0f, 1.0f, 1.0f};
+
+							// Recursively bounce the photon around the scene
+							absorb_vp(sr, ray, world, amount, rng);
+
+							VisiblePoint &slot =
+								(*slots)[static_cast<std::size_t>(i - start_y) *
+											 width +
+										 (j - start_x)];
+							slot = VisiblePoint(j,
+												i,
+												sr.get_hitpoint(),
+												-ray.d,
+												amount,
+												sr.m_material);
+							slot.contribution = direct;
+						}
 					}
 				}
-
-				// Find the index in our film where we will link this ray to
-				int row_0_indexed =
-					static_cast<int>(i) + (world->m_vp->vres) / 2;
-				int col_0_indexed =
-					static_cast<int>(j) + (world->m_vp->hres) / 2;
-
-				// If we have hit an object, create a visible point at the
-				// surface interaction point
-				if (hit && sr.m_material) {
-					// Shade the point directly
-					storage->at(world->m_vp->vres - row_0_indexed - 1)
-						.at(col_0_indexed) +=
-						(sr.m_material->shade(sr, *(world)));
-
-					Colour amount{1.0f, 1.0f, 1.0f};
-
-					// Recursively bounce the photon around the scene
-					absorb_vp(sr, ray, world, amount);
-
-					// Add this visible point to our vector
-					visiblePoints.push_back(
-						std::make_shared<poly::integrators::VisiblePoint>(
-							j,
-							i,
-							sr.get_hitpoint(),
-							-ray.d,
-							amount,
-							sr.m_material,
-							storage,
-							world));
-				}
+			}
+		};
+
+		// Split the camera pass between the cores left over by the
+		// concurrently running iterations
+		std::size_t num_threads = std::min<std::size_t>(
+			std::max<std::size_t>(
+				camera.get_max_threads() /
+					std::max<std::size_t>(m_num_working_areas, 1),
+				1),
+			static_cast<std::size_t>(num_tiles));
+
+		poly::utils::ThreadPool::instance().parallel_for(
+			num_threads, [&](std::size_t) { trace_tiles(); }, num_threads);
+
+		// Compact the hit slots in pixel order. The pointers share ownership
+		// of the slot block instead of allocating every point separately
+		std::vector<std::shared_ptr<poly::object::Object>> visiblePoints;
+		visiblePoints.reserve(slots->size());
+		for (VisiblePoint &vp : *slots) {
+			if (vp.surface_material) {
+				visiblePoints.push_back(
+					std::shared_ptr<poly::object::Object>(slots, &vp));
 			}
 		}
 		return visiblePoints;
@@ -272,34 +452,105 @@ namespace poly::integrators
 	void SPPMIntegrator::photon_mapping(
 		const poly::structures::World &world,
 		std::vector<std::shared_ptr<poly::object::Object>> &vp_list,
-		std::shared_ptr<std::mutex> storage_mutex)
+		std::size_t iteration)
 	{
 		poly::structures::KDTree vp_tree(vp_list, 80, 30, 0.75f, 10, -1);
 
-		const std::size_t photon_count =
+		const std::size_t photons_per_light =
 			m_num_photons_per_iteration; // TODO: Make configurable by end user
 
-		for (auto &light : world.m_lights) {
+		// Every light emits the same number of photons, unless the world
+		// samples its lights. The photons of the lights in the light tree
+		// are then shared out by power, and scaled by the count each light
+		// was expected to get over the count it got
+		std::vector<std::size_t> photon_counts(world.m_lights.size(),
+											   photons_per_light);
+		std::vector<float> light_scales(world.m_lights.size(), 1.0f);
+		if (world.light_sampling()) {
+			poly::structures::LightTree const &tree = *world.m_light_tree;
+			std::size_t total = photons_per_light * tree.size();
+			std::vector<float> pdfs(world.m_lights.size(), 0.0f);
+			for (std::size_t l{0}; l < world.m_lights.size(); ++l) {
+				if (world.m_lights[l]->has_position()) {
+					photon_counts[l] = 0;
+				}
+			}
+
+			// Stratified draws, so every light gets close to its share
+			poly::utils::Random rng{poly::utils::RandomDomain::light,
+									{iteration}};
+			for (std::size_t i{0}; i < total; ++i) {
+				float pdf;
+				std::uint32_t l = tree.sample_power(
+					(static_cast<float>(i) + rng.uniform()) /
+						static_cast<float>(total),
+					pdf);
+				++photon_counts[l];
+				pdfs[l] = pdf;
+			}
+
+			for (std::size_t l{0}; l < world.m_lights.size(); ++l) {
+				if (pdfs[l] > 0.0f) {
+					light_scales[l] = static_cast<float>(photon_counts[l]) /
+									  (static_cast<float>(total) * pdfs[l]);
+				}
+			}
+		}
+
+		for (std::size_t l{0}; l < world.m_lights.size(); ++l) {
+			auto &light = world.m_lights[l];
+			const std::size_t photon_count = photon_counts[l];
+			if (photon_count == 0) {
+				continue;
+			}
+			poly::structures::ProjectionMap const *map =
+				l < m_projection_maps.size() ? &m_projection_maps[l] : nullptr;
+
+			// Split the budget between the directions marked in the
+			// projection map and the rest of the sphere. Each group carries
+			// the power of the solid angle it covers, so the estimate stays
+			// unbiased while the caustics receive far more photons
+			float coverage = map ? map->coverage() : 0.0f;
+			std::size_t caustic_count{0};
+			if (coverage > 0.0f && coverage < 1.0f && photon_count > 1) {
+				caustic_count = std::min(
+					static_cast<std::size_t>(m_caustic_photon_fraction *
+											 static_cast<float>(photon_count)),
+					photon_count - 1);
+			}
+			std::size_t global_count = photon_count - caustic_count;
+
 			for (std::size_t i{0}; i < photon_count; ++i) {
-				float x, y, z;
-				do {
-					x = 2.0f * (((float)(rand() % 10000)) / 10000.0f) - 1.0f;
-					y = 2.0f * (((float)(rand() % 10000)) / 10000.0f) - 1.0f;
-					z = 2.0f * (((float)(rand() % 10000)) / 10000.0f) - 1.0f;
-				} while (x * x + y * y + z * z > 1.0f);
-
-				math::Vector d{x, y, z};
-				// d = glm::normalize(d); // TODO replace with random class
+				// One stream per photon, its bounces draw in sequence
+				poly::utils::Random rng{poly::utils::RandomDomain::photon,
+										{iteration, l, i}};
+
+				math::Vector d;
+				float share;
+				if (i < caustic_count) {
+					d	  = map->sample_marked(rng);
+					share = coverage / static_cast<float>(caustic_count);
+				}
+				else if (caustic_count > 0) {
+					d	  = map->sample_unmarked(rng);
+					share = (1.0f - coverage) / static_cast<float>(global_count);
+				}
+				else {
+					float x, y, z;
+					do {
+						x = 2.0f * rng.uniform() - 1.0f;
+						y = 2.0f * rng.uniform() - 1.0f;
+						z = 2.0f * rng.uniform() - 1.0f;
+					} while (x * x + y * y + z * z > 1.0f);
+					d	  = math::Vector{x, y, z};
+					share = 1.0f / static_cast<float>(photon_count);
+				}
+
 				math::Point o{light->location()};
 				math::Ray<math::Vector> photon_ray{o, d};
 				structures::SurfaceInteraction si;
 
-				bool is_hit{false};
-				for (auto &obj : world.m_scene) {
-					if (obj->hit(photon_ray, si)) {
-						is_hit = true;
-					}
-				}
+				bool is_hit = world.closest_hit(photon_ray, si);
 
 				if (is_hit) {
 					poly::structures::Photon photon = poly::structures::Photon(
@@ -307,10 +558,7 @@ namespace poly::integrators
 						si.get_hitpoint(),
 						si.m_normal,
 						m_number_iterations * m_photon_strength_multiplier *
-							light->ls() /
-							static_cast<float>(
-								photon_count), // scale the photon's strength by
-											   // 1000
+							light->ls() * light_scales[l] * share,
 						0);
 
 					// Using this photon, absorb will determine the behaviour of
@@ -320,7 +568,7 @@ namespace poly::integrators
 								  vp_tree,
 								  (std::size_t)world.m_vp->max_depth,
 								  world,
-								  storage_mutex);
+								  rng);
 				}
 			}
 		}
@@ -332,23 +580,30 @@ namespace poly::integrators
 	===============================
 	*/
 
+	VisiblePoint::VisiblePoint() :
+		index_x{0},
+		index_y{0},
+		point{},
+		w_i{},
+		amount{0.0f, 0.0f, 0.0f},
+		surface_material{nullptr},
+		contribution{0.0f, 0.0f, 0.0f}
+	{}
+
 	VisiblePoint::VisiblePoint(
 		int x_,
 		int y_,
 		math::Point const &point_,
 		math::Vector const &incoming_ray_,
 		Colour amount_,
-		std::shared_ptr<poly::material::Material> material_,
-		std::shared_ptr<std::vector<std::vector<Colour>>> storage_,
-		std::shared_ptr<poly::structures::World> world_) :
+		poly::material::Material const *material_) :
 		index_x{x_},
 		index_y{y_},
 		point(point_),
 		w_i(incoming_ray_),
 		amount{amount_},
 		surface_material{material_},
-		m_storage{storage_},
-		m_world{world_}
+		contribution{0.0f, 0.0f, 0.0f}
 	{
 		// Ensure that our point gets its bounds set
 		assert(surface_material);
@@ -373,13 +628,15 @@ namespace poly::integrators
 		return false;
 	}
 
-	void VisiblePoint::add_contribution(
-		poly::structures::Photon const &photon,
-		[[maybe_unused]] std::shared_ptr<std::mutex> storage_mutex)
+	void VisiblePoint::interaction_resolve(
+		poly::structures::SurfaceInteraction &sr) const
 	{
-		int row_0_indexed = (int)index_y + (m_world->m_vp->vres) / 2;
-		int col_0_indexed = (int)index_x + (m_world->m_vp->hres) / 2;
+		sr.m_material = surface_material;
+	}
 
+	void VisiblePoint::add_contribution(
+		poly::structures::Photon const &photon)
+	{
 		float dist_x = point.x - photon.point().x;
 		float dist_y = point.y - photon.point().y;
 		float dist_z = point.z - photon.point().z;
@@ -389,8 +646,8 @@ namespace poly::integrators
 
 		Colour intensity = amount * photon.intensity();
 
-		m_storage->at(m_world->m_vp->vres - row_0_indexed - 1)
-			.at(col_0_indexed) += intensity / dist_to_vp;
+		// Only this iteration's thread touches its visible points
+		contribution += intensity / dist_to_vp;
 	}
 
 } // namespace poly::integrators
@@ -403,17 +660,18 @@ namespace poly::integrators
 
 void absorb_vp(poly::structures::SurfaceInteraction &sr,
 			   atlas::math::Ray<atlas::math::Vector> const &ray,
-			   std::shared_ptr<poly::structures::World> world,
-			   Colour &amount)
+			   poly::structures::World const &world,
+			   Colour &amount,
+			   poly::utils::Random &rng)
 {
 	// If we've reached the max depth, we stay here!
-	if (world->m_vp->max_depth <= sr.depth) {
+	if (world.m_vp->max_depth <= sr.depth) {
 		return;
 	}
 
 	++sr.depth;
 
-	std::shared_ptr<poly::material::Material> current_material = sr.m_material;
+	poly::material::Material const *current_material = sr.m_material;
 
 	// Scale the amount of light transmitted through to the film by the colour
 	// of the transmitted material
@@ -423,11 +681,10 @@ void absorb_vp(poly::structures::SurfaceInteraction &sr,
 		// Assess whether or not this should be bounced by taking the intensity
 		// of the diffuse component of the material
 		float partition = current_material->get_diffuse_strength();
-		float rgn		= (((float)(rand() % 10000)) /
-					   10000.0f); // TODO: fix this, it is not portable
+		float rgn		= rng.uniform();
 		if (rgn > partition) {
 			// Bounce the photon off this material
-			bounce_vp(sr, ray, world, amount);
+			bounce_vp(sr, ray, world, amount, rng);
 		}
 		return;
 	}
@@ -438,10 +695,10 @@ void absorb_vp(poly::structures::SurfaceInteraction &sr,
 		float diffuse_kd	= current_material->get_diffuse_strength();
 		float total			= reflective_kd + diffuse_kd + specular_kd;
 
-		float rgn = (((float)(rand() % 10000)) / 10000.0f) * total;
+		float rgn = rng.uniform() * total;
 
 		if (rgn < reflective_kd) {
-			bounce_vp(sr, ray, world, amount);
+			bounce_vp(sr, ray, world, amount, rng);
 		}
 	}
 	else if (current_material->m_type ==
@@ -453,22 +710,23 @@ void absorb_vp(poly::structures::SurfaceInteraction &sr,
 		float total = transparent_kt + specular_kd + reflective_kd + diffuse_kd;
 
 		// Random number in the range 0 to total
-		float random_number = (((float)(rand() % 10000)) / 10000.0f) * total;
+		float random_number = rng.uniform() * total;
 
 		if (random_number < transparent_kt) {
-			transmit_vp(sr, ray, world, amount);
+			transmit_vp(sr, ray, world, amount, rng);
 		}
 		else if (random_number >= transparent_kt &&
 				 random_number < transparent_kt + reflective_kd) {
-			bounce_vp(sr, ray, world, amount);
+			bounce_vp(sr, ray, world, amount, rng);
 		}
 	}
 }
 
 void bounce_vp(poly::structures::SurfaceInteraction &sr,
 			   atlas::math::Ray<atlas::math::Vector> const &ray,
-			   std::shared_ptr<poly::structures::World> world,
-			   Colour &amount)
+			   poly::structures::World const &world,
+			   Colour &amount,
+			   poly::utils::Random &rng)
 {
 	math::Ray<math::Vector> reflected_ray(
 		sr.get_hitpoint(),
@@ -477,25 +735,21 @@ void bounce_vp(poly::structures::SurfaceInteraction &sr,
 	sr.m_tmin = std::numeric_limits<float>::max();
 
 	// Hit new objects with this ray
-	bool is_hit{false};
-	for (auto &obj : world->m_scene) {
-		if (obj->hit(reflected_ray, sr)) {
-			is_hit = true;
-		}
-	}
+	bool is_hit = world.closest_hit(reflected_ray, sr);
 
 	// If we hit an object, get its material and propogate this vp
 	if (is_hit) {
-		absorb_vp(sr, reflected_ray, world, amount);
+		absorb_vp(sr, reflected_ray, world, amount, rng);
 	}
 }
 
 void transmit_vp(poly::structures::SurfaceInteraction &sr,
 				 atlas::math::Ray<atlas::math::Vector> const &ray,
-				 std::shared_ptr<poly::structures::World> world,
-				 Colour &amount)
+				 poly::structures::World const &world,
+				 Colour &amount,
+				 poly::utils::Random &rng)
 {
-	std::shared_ptr<poly::material::Material> current_material = sr.m_material;
+	poly::material::Material const *current_material = sr.m_material;
 	atlas::math::Vector wi									   = -ray.d;
 	atlas::math::Vector wt;
 
@@ -507,17 +761,12 @@ void transmit_vp(poly::structures::SurfaceInteraction &sr,
 	sr.m_tmin = std::numeric_limits<float>::max();
 
 	// Send the transmitted ray through the scene
-	bool is_hit{false};
-	for (auto &obj : world->m_scene) {
-		if (obj->hit(transmitted_ray, sr)) {
-			is_hit = true;
-		}
-	}
+	bool is_hit = world.closest_hit(transmitted_ray, sr);
 
 	// If we hit an object, possibly generate new rays, otherwise, simply change
 	// the photons intensity
 	if (is_hit) {
-		absorb_vp(sr, transmitted_ray, world, amount);
+		absorb_vp(sr, transmitted_ray, world, amount, rng);
 	}
 }
 
@@ -541,22 +790,22 @@ point, add the photon's value to it's light contribution
 PSEUDOCODE FOR ALGORITHM
 
 */
-void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
+void absorb_photon(poly::material::Material const *current_material,
 				   poly::structures::Photon &photon,
 				   poly::structures::KDTree &vp_tree,
 				   std::size_t max_depth,
 				   poly::structures::World const &world,
-				   std::shared_ptr<std::mutex> storage_mutex)
+				   poly::utils::Random &rng)
 {
 	constexpr float max_distance_to_visible_point = 30.0f;
 	// If the max depth for recursion is reached, stop here
 	if (photon.depth() >= max_depth) {
 		// photons.push_back(photon);
-		std::vector<std::shared_ptr<poly::object::Object>> nearby_VPs =
+		std::vector<poly::object::Object *> nearby_VPs =
 			vp_tree.get_nearest_to_point(photon.point(),
 										 max_distance_to_visible_point);
-		for (auto &vp : nearby_VPs) {
-			vp->add_contribution(photon, storage_mutex);
+		for (poly::object::Object *vp : nearby_VPs) {
+			vp->add_contribution(photon);
 		}
 		// Add contribution to nearby VP's
 		return;
@@ -566,8 +815,7 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 		// Assess whether or not this should be bounced by taking the intensity
 		// of the diffuse component of the material
 		float partition = current_material->get_diffuse_strength();
-		float rgn		= (((float)(rand() % 10000)) /
-					   10000.0f); // TODO: fix this, it is not portable
+		float rgn		= rng.uniform();
 		if (rgn > partition) {
 			// Bounce the photon off this material
 			bounce_photon(current_material,
@@ -576,14 +824,14 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 						  max_depth,
 						  world,
 						  partition,
-						  storage_mutex);
+						  rng);
 		}
 		// TODO: Add contribution to nearby VP's if no bounce!!!
-		std::vector<std::shared_ptr<poly::object::Object>> nearby_VPs =
+		std::vector<poly::object::Object *> nearby_VPs =
 			vp_tree.get_nearest_to_point(photon.point(),
 										 max_distance_to_visible_point);
-		for (auto &vp : nearby_VPs) {
-			vp->add_contribution(photon, storage_mutex);
+		for (poly::object::Object *vp : nearby_VPs) {
+			vp->add_contribution(photon);
 		}
 		return;
 	}
@@ -594,7 +842,7 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 		float diffuse_kd	= current_material->get_diffuse_strength();
 		float total			= reflective_kd + diffuse_kd + specular_kd;
 
-		float rgn = (((float)(rand() % 10000)) / 10000.0f) * total;
+		float rgn = rng.uniform() * total;
 
 		if (rgn < reflective_kd) {
 			bounce_photon(current_material,
@@ -603,7 +851,7 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 						  max_depth,
 						  world,
 						  (photon.intensity() * reflective_kd / total),
-						  storage_mutex);
+						  rng);
 		}
 		photon.intensity(photon.intensity() * (1 - (reflective_kd / total)));
 		// photons.push_back(photon);
@@ -617,7 +865,7 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 		float total = transparent_kt + specular_kd + reflective_kd + diffuse_kd;
 
 		// Random number in the range 0 to total
-		float random_number = (((float)(rand() % 10000)) / 10000.0f) * total;
+		float random_number = rng.uniform() * total;
 
 		if (random_number < transparent_kt) {
 			transmit_photon(current_material,
@@ -626,7 +874,7 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 							max_depth,
 							world,
 							photon.intensity() * transparent_kt / total,
-							storage_mutex);
+							rng);
 		}
 		else if (random_number >= transparent_kt &&
 				 random_number < transparent_kt + reflective_kd) {
@@ -637,7 +885,7 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 						  world,
 						  (reflective_kd + reflective_kd) / total *
 							  photon.intensity(),
-						  storage_mutex);
+						  rng);
 		}
 		photon.intensity(photon.intensity() * diffuse_kd / total);
 		// Add photon contribution to VP
@@ -645,25 +893,20 @@ void absorb_photon(std::shared_ptr<poly::material::Material> current_material,
 }
 
 void bounce_photon(
-	[[maybe_unused]] std::shared_ptr<poly::material::Material> current_material,
+	[[maybe_unused]] poly::material::Material const *current_material,
 	poly::structures::Photon &photon,
 	poly::structures::KDTree &vp_tree,
 	std::size_t max_depth,
 	poly::structures::World const &world,
 	float object_colour_intensity,
-	std::shared_ptr<std::mutex> storage_mutex)
+	poly::utils::Random &rng)
 {
 	poly::structures::SurfaceInteraction si;
 	// Get the new ray direction from the photon
 	atlas::math::Ray<atlas::math::Vector> photon_ray = photon.reflect_ray();
 
 	// Hit new objects with this ray
-	bool is_hit{false};
-	for (auto &obj : world.m_scene) {
-		if (obj->hit(photon_ray, si)) {
-			is_hit = true;
-		}
-	}
+	bool is_hit = world.closest_hit(photon_ray, si);
 
 	// If we hit an object, get its material and propogate this photon
 	if (is_hit) {
@@ -678,19 +921,19 @@ void bounce_photon(
 					  vp_tree,
 					  max_depth,
 					  world,
-					  storage_mutex);
+					  rng);
 	}
 	float new_intensity = photon.intensity() * object_colour_intensity;
 	photon.intensity(new_intensity);
 }
 
-void transmit_photon(std::shared_ptr<poly::material::Material> current_material,
+void transmit_photon(poly::material::Material const *current_material,
 					 poly::structures::Photon &photon,
 					 poly::structures::KDTree &vp_tree,
 					 std::size_t max_depth,
 					 poly::structures::World const &world,
 					 float colour_change,
-					 std::shared_ptr<std::mutex> storage_mutex)
+					 poly::utils::Random &rng)
 {
 	poly::structures::SurfaceInteraction si;
 	si.m_normal			   = photon.normal();
@@ -702,11 +945,7 @@ void transmit_photon(std::shared_ptr<poly::material::Material> current_material,
 	atlas::math::Ray<atlas::math::Vector> photon_ray{photon.point(), wt};
 
 	// Send the transmitted ray through the scene
-	bool is_hit{false};
-	for (auto &obj : world.m_scene) {
-		if (obj->hit(photon_ray, si))
-			is_hit = true;
-	}
+	bool is_hit = world.closest_hit(photon_ray, si);
 
 	// If we hit an object, possibly generate new rays, otherwise, simply change
 	// the photons intensity
@@ -722,7 +961,7 @@ void transmit_photon(std::shared_ptr<poly::material::Material> current_material,
 					  vp_tree,
 					  max_depth,
 					  world,
-					  storage_mutex);
+					  rng);
 	}
 	float new_intensity = photon.intensity() * colour_change;
 	photon.intensity(new_intensity);
@@ -36,7 +36,7 @@ namespace poly::light
 		// Take any one index of our samplers samples
 		// This enables us to have multiple threads access the samples
 		// without needing to guard access with mutexes
-		std::vector<float> sp = m_sampler->sample_hemisphere(sample_index);
+		atlas::math::Vector sp = m_sampler->sample_hemisphere(sample_index);
 
 		// For multithreading, its important that these aren't global
 		atlas::math::Vector w = sr.m_normal;
@@ -44,7 +44,7 @@ namespace poly::light
 			glm::cross(atlas::math::Vector(0.0f, 1.0f, 0.0f), w));
 		atlas::math::Vector v = glm::normalize(glm::cross(w, u));
 
-		return (sp.at(0) * u + sp.at(1) * v + sp.at(2) * w);
+		return (sp.x * u + sp.y * v + sp.z * w);
 	}
 
 	Colour AmbientOcclusion::L(poly::structures::SurfaceInteraction& sr,
@@ -21,19 +21,33 @@ namespace poly::light
 
 	Colour DirectionalLight::L(poly::structures::SurfaceInteraction &sr,
 							   poly::structures::World const &world)
+	{
+		atlas::math::Ray<atlas::math::Vector> ray;
+		shadow_ray(sr, ray);
+		if (in_shadow(ray, world)) {
+			return Colour(0.0f, 0.0f, 0.0f);
+		}
+		else {
+			return unoccluded_L(sr, world);
+		}
+	}
+
+	bool DirectionalLight::shadow_ray(poly::structures::SurfaceInteraction &sr,
+									  atlas::math::Ray<atlas::math::Vector> &ray)
 	{
 		atlas::math::Point new_origin	  = sr.get_hitpoint();
 		atlas::math::Vector new_direction = glm::normalize(direction_get(sr));
 
-		atlas::math::Ray shadow_ray(
+		ray = atlas::math::Ray<atlas::math::Vector>(
 			new_origin + (m_surface_epsilon * new_direction), new_direction);
+		return true;
+	}
 
-		if (in_shadow(shadow_ray, world)) {
-			return Colour(0.0f, 0.0f, 0.0f);
-		}
-		else {
-			return m_colour * m_ls;
-		}
+	Colour DirectionalLight::unoccluded_L(
+		[[maybe_unused]] poly::structures::SurfaceInteraction &sr,
+		[[maybe_unused]] poly::structures::World const &world)
+	{
+		return m_colour * m_ls;
 	}
 
 	// TODO: Define a location for the directional light to be
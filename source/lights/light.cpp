@@ -26,7 +26,7 @@ namespace poly::light
 						  poly::structures::World const& world)
 	{
 		float t;
-		for (std::shared_ptr<poly::object::Object> object : world.m_scene) {
+		for (auto const& object : world.m_scene) {
 			if (object->shadow_hit(shadow_ray, t) && t > m_surface_epsilon) {
 				return true;
 			}
@@ -34,8 +34,48 @@ namespace poly::light
 		return false;
 	}
 
+	bool Light::shadow_ray(
+		[[maybe_unused]] poly::structures::SurfaceInteraction& sr,
+		[[maybe_unused]] math::Ray<math::Vector>& ray)
+	{
+		return false;
+	}
+
+	Colour Light::unoccluded_L(poly::structures::SurfaceInteraction& sr,
+							   poly::structures::World const& world)
+	{
+		return L(sr, world);
+	}
+
+	bool Light::occluded(math::Ray<math::Vector> const& shadow_ray,
+						 poly::structures::World const& world)
+	{
+		return in_shadow(shadow_ray, world);
+	}
+
+	void Light::occluded(
+		std::vector<math::Ray<math::Vector>> const& shadow_rays,
+		poly::structures::World const& world,
+		std::vector<bool>& blocked)
+	{
+		blocked.assign(shadow_rays.size(), false);
+		for (std::size_t i{0}; i < shadow_rays.size(); ++i) {
+			blocked[i] = in_shadow(shadow_rays[i], world);
+		}
+	}
+
 	float Light::ls() const
 	{
 		return m_ls;
 	}
+
+	float Light::power() const
+	{
+		return m_ls * (m_colour.x + m_colour.y + m_colour.z) / 3.0f;
+	}
+
+	bool Light::has_position() const
+	{
+		return false;
+	}
 } // namespace poly::light
@@ -5,6 +5,9 @@
 
 namespace poly::light
 {
+	// Shadow rays traced together, sharing one culled object list
+	static constexpr std::size_t packet_size = 64;
+
 	PointLight::PointLight() : Light()
 	{
 		m_location = atlas::math::Vector(0.0f, 0.0f, 0.0f);
@@ -37,7 +40,7 @@ namespace poly::light
 		atlas::math::Vector line_between = m_location - shadow_ray.o;
 		float line_distance = sqrt(glm::dot(line_between, line_between));
 
-		for (std::shared_ptr<poly::object::Object> object : world.m_scene) {
+		for (auto const& object : world.m_scene) {
 			// If we hit an object with distance less than max
 			if (object->shadow_hit(shadow_ray, t) && t < line_distance) {
 				return true;
@@ -47,28 +50,106 @@ namespace poly::light
 		return false;
 	}
 
+	/**
+	Traces shadow rays in packets. All rays of a packet end at the light,
+	so the box around their origins and the light holds every segment, and
+	objects outside it are skipped for the whole packet. Packets are taken in
+	order, so callers should pass nearby rays next to each other
+
+	@param shadow_rays rays from the shading points towards this light
+	@param world the world holding the objects
+	@param blocked set for every ray that does not reach the light
+	*/
+	void PointLight::occluded(
+		std::vector<math::Ray<math::Vector>> const& shadow_rays,
+		poly::structures::World const& world,
+		std::vector<bool>& blocked)
+	{
+		blocked.assign(shadow_rays.size(), false);
+		std::vector<poly::object::Object const*> candidates;
+
+		for (std::size_t first{0}; first < shadow_rays.size();
+			 first += packet_size) {
+			std::size_t last = std::min(first + packet_size, shadow_rays.size());
+
+			math::Vector lower = m_location;
+			math::Vector upper = m_location;
+			for (std::size_t i{first}; i < last; ++i) {
+				lower = glm::min(lower, shadow_rays[i].o);
+				upper = glm::max(upper, shadow_rays[i].o);
+			}
+			// Hits are found a little off the surface, pad to be safe
+			math::Vector padding(m_surface_epsilon);
+			lower -= padding;
+			upper += padding;
+
+			candidates.clear();
+			for (auto const& object : world.m_scene) {
+				poly::structures::Bounds3D bounds = object->get_boundbox();
+				if (bounds.pMax.x >= lower.x && bounds.pMin.x <= upper.x &&
+					bounds.pMax.y >= lower.y && bounds.pMin.y <= upper.y &&
+					bounds.pMax.z >= lower.z && bounds.pMin.z <= upper.z) {
+					candidates.push_back(object.get());
+				}
+			}
+
+			for (std::size_t i{first}; i < last; ++i) {
+				// Same test as in_shadow, over the candidates only
+				math::Vector line_between = m_location - shadow_rays[i].o;
+				float line_distance = sqrt(glm::dot(line_between, line_between));
+				for (poly::object::Object const* object : candidates) {
+					float t{std::numeric_limits<float>::max()};
+					if (object->shadow_hit(shadow_rays[i], t) &&
+						t < line_distance) {
+						blocked[i] = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
 	Colour PointLight::L(poly::structures::SurfaceInteraction& sr,
 						 poly::structures::World const& world)
 	{
-		math::Point new_origin	   = sr.get_hitpoint();
-		math::Vector new_direction = glm::normalize(get_direction(sr));
-
-		math::Ray shadow_ray(new_origin + (m_surface_epsilon * new_direction),
-							 new_direction);
-		if (in_shadow(shadow_ray, world)) {
+		math::Ray<math::Vector> ray;
+		shadow_ray(sr, ray);
+		if (in_shadow(ray, world)) {
 			return Colour(0.0f, 0.0f, 0.0f);
 		}
 		else {
-			math::Vector vector =
-				glm::normalize(m_location - sr.get_hitpoint());
-			float r_squared = glm::dot(vector, vector);
-			return m_colour * m_ls / (r_squared);
+			return unoccluded_L(sr, world);
 		}
 	}
 
+	bool PointLight::shadow_ray(poly::structures::SurfaceInteraction& sr,
+								math::Ray<math::Vector>& ray)
+	{
+		math::Point new_origin	   = sr.get_hitpoint();
+		math::Vector new_direction = glm::normalize(get_direction(sr));
+
+		ray = math::Ray<math::Vector>(
+			new_origin + (m_surface_epsilon * new_direction), new_direction);
+		return true;
+	}
+
+	Colour PointLight::unoccluded_L(
+		poly::structures::SurfaceInteraction& sr,
+		[[maybe_unused]] poly::structures::World const& world)
+	{
+		math::Vector vector = glm::normalize(m_location - sr.get_hitpoint());
+		float r_squared		= glm::dot(vector, vector);
+		return m_colour * m_ls / (r_squared);
+	}
+
 	math::Point PointLight::location() const
 	{
 		return m_location;
 	}
 
+	bool PointLight::has_position() const
+	{
+		return true;
+	}
+
 } // namespace poly::light
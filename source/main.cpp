@@ -6,6 +6,9 @@
 
 #include "integrators/SPPMIntegrator.hpp"
 #include "utilities/parser.hpp"
+#include "utilities/random.hpp"
+#include "utilities/stop_signal.hpp"
+#include "utilities/thread_pool.hpp"
 
 #define POLY_USING_SPPM
 
@@ -18,9 +21,6 @@ int main(int argc, char** argv)
 		exit(1);
 	}
 
-	// Time seed RNG
-	srand((unsigned int)time(0));
-
 	/*
 	Open the JSON file specified as the first argument to the program
 
@@ -38,6 +38,28 @@ int main(int argc, char** argv)
 		exit(1);
 	}
 
+	// Seed every random stream, a fixed seed makes renders repeatable
+	try {
+		poly::utils::set_random_seed(poly::utils::parse_seed(taskfile));
+	}
+	catch (const nlohmann::detail::type_error& e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << "ERROR: seed could not be parsed. Exiting..." << std::endl;
+		exit(1);
+	}
+
+	// One pool of worker threads serves scene loading and rendering
+	try {
+		poly::utils::ThreadPool::initialize(poly::utils::thread_count(taskfile),
+											poly::utils::pin_threads(taskfile));
+	}
+	catch (const nlohmann::detail::type_error& e) {
+		std::cerr << e.what() << std::endl;
+		std::cerr << "ERROR: thread settings could not be parsed. Exiting..."
+				  << std::endl;
+		exit(1);
+	}
+
 	/*
 	Create the world (objects, lights, materials, textures, image information)
 	If any object fails construction, the program will exit with code 1
@@ -88,6 +110,9 @@ int main(int argc, char** argv)
 	bool using_sppm =
 		poly::utils::create_SPPMIntegrator(stoch_prog_phot_mapper, taskfile);
 	if (using_sppm == true) {
+		// SIGTERM ends the render early, the image so far is still written
+		// out
+		poly::utils::install_stop_handler();
 		stoch_prog_phot_mapper.render(world, camera, output);
 	}
 #else
@@ -95,6 +120,12 @@ int main(int argc, char** argv)
 #endif
 
 	if (using_sppm == false) {
+		// Only progressive renders poll for a stop, the others leave SIGTERM
+		// to end the process as before
+		if (camera.progressive()) {
+			poly::utils::install_stop_handler();
+		}
+
 		// Create the required output file
 		camera.multithread_render_scene(world, output);
 	}
@@ -35,7 +35,7 @@ namespace poly::material
 			a = m_diffuse->rho(sr, nullVec) * world.m_ambient->L(sr, world);
 		}
 
-		for (std::shared_ptr<poly::light::Light> light : world.m_lights) {
+		for (auto const& light : world.m_lights) {
 			Colour brdf = m_diffuse->f(sr, nullVec, nullVec);
 			Colour L	= light->L(sr, world);
 			float angle = glm::dot(sr.m_normal, light->get_direction(sr));
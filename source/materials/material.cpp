@@ -1,10 +1,99 @@
 #include "materials/material.hpp"
+#include "lights/light.hpp"
+#include "tracers/tracer.hpp"
+#include "structures/light_tree.hpp"
 
 namespace poly::material
 {
 	Material::Material() : m_type{poly::structures::InteractionType::ABSORB}
 	{}
 
+	/**
+	Shades a hit depth first, tracing every scattered ray straight away
+
+	@param sr the hit to shade
+	@param world the world holding the lights and the tracer
+
+	@returns the light leaving sr towards the eye
+	*/
+	Colour Material::shade(poly::structures::SurfaceInteraction& sr,
+						   poly::structures::World const& world) const
+	{
+		Colour L = shade_direct(sr, world);
+
+		std::vector<ScatteredRay> rays;
+		scatter(sr, rays);
+		for (ScatteredRay const& scattered : rays) {
+			// Each branch carries this path's weight scaled by its own BxDF,
+			// so the tracer can skip whichever one is negligible
+			L += scattered.weight *
+				 world.m_tracer->trace_ray(scattered.ray,
+										   world,
+										   sr.depth + 1,
+										   sr.m_throughput * scattered.weight);
+		}
+
+		return L;
+	}
+
+	/**
+	Shades a hit from the ambient light and the lights the world selects for
+	it, every light unless light sampling is on. Shadow rays are only traced
+	for lights that contribute
+
+	@param sr the hit to shade
+	@param world the world holding the lights
+
+	@returns the light leaving sr towards the eye, without reflections
+	*/
+	Colour Material::shade_direct(poly::structures::SurfaceInteraction& sr,
+								  poly::structures::World const& world) const
+	{
+		Colour a = shade_ambient(sr, world);
+		Colour r = Colour(0.0f, 0.0f, 0.0f);
+
+		std::vector<poly::structures::LightSample> lights;
+		world.select_lights(sr, lights);
+		for (poly::structures::LightSample const& sample : lights) {
+			auto const& light = world.m_lights[sample.light];
+			atlas::math::Vector w_i = light->get_direction(sr);
+			Colour contribution		= shade_light(
+				sr, w_i, sample.weight * light->unoccluded_L(sr, world));
+			if (contribution == Colour(0.0f, 0.0f, 0.0f)) {
+				continue;
+			}
+
+			atlas::math::Ray<atlas::math::Vector> shadow_ray;
+			if (light->shadow_ray(sr, shadow_ray) &&
+				light->occluded(shadow_ray, world)) {
+				continue;
+			}
+			r += contribution;
+		}
+
+		return (a + r);
+	}
+
+	Colour Material::shade_ambient(
+		[[maybe_unused]] poly::structures::SurfaceInteraction& sr,
+		[[maybe_unused]] poly::structures::World const& world) const
+	{
+		return Colour(0.0f, 0.0f, 0.0f);
+	}
+
+	Colour Material::shade_light(
+		[[maybe_unused]] poly::structures::SurfaceInteraction const& sr,
+		[[maybe_unused]] atlas::math::Vector const& w_i,
+		[[maybe_unused]] Colour const& L) const
+	{
+		return Colour(0.0f, 0.0f, 0.0f);
+	}
+
+	void Material::scatter(
+		[[maybe_unused]] poly::structures::SurfaceInteraction const& sr,
+		[[maybe_unused]] std::vector<ScatteredRay>& rays) const
+	{}
+
 	Colour Material::sample_f(
 		[[maybe_unused]] poly::structures::SurfaceInteraction const& sr,
 		[[maybe_unused]] atlas::math::Vector& w_o,
@@ -17,31 +17,26 @@ namespace poly::material
 		m_type	  = poly::structures::InteractionType::ABSORB;
 	}
 
-	Colour Matte::shade(poly::structures::SurfaceInteraction &sr,
-						poly::structures::World const &world) const
+	Colour Matte::shade_ambient(poly::structures::SurfaceInteraction &sr,
+								poly::structures::World const &world) const
 	{
-		// Render loop
-		Colour r = Colour(0.0f, 0.0f, 0.0f);
-		Colour a = Colour(0.0f, 0.0f, 0.0f);
 		atlas::math::Vector nullVec(0.0f, 0.0f, 0.0f);
-
 		if (world.m_ambient) {
-			a = m_diffuse->rho(sr, nullVec) * world.m_ambient->L(sr, world);
+			return m_diffuse->rho(sr, nullVec) * world.m_ambient->L(sr, world);
 		}
+		return Colour(0.0f, 0.0f, 0.0f);
+	}
 
-		for (std::shared_ptr<poly::light::Light> light : world.m_lights) {
-			Colour brdf = m_diffuse->f(sr, nullVec, nullVec);
-			Colour L	= light->L(sr, world);
-			float angle = glm::dot(sr.m_normal, light->get_direction(sr));
-			if (angle > 0) {
-				r += (brdf * L * angle);
-			}
-			else {
-				r += Colour(0.0f, 0.0f, 0.0f);
-			}
+	Colour Matte::shade_light(poly::structures::SurfaceInteraction const &sr,
+							  atlas::math::Vector const &w_i,
+							  Colour const &L) const
+	{
+		atlas::math::Vector nullVec(0.0f, 0.0f, 0.0f);
+		float angle = glm::dot(sr.m_normal, w_i);
+		if (angle > 0) {
+			return (m_diffuse->f(sr, nullVec, nullVec) * L * angle);
 		}
-
-		return (a + r);
+		return Colour(0.0f, 0.0f, 0.0f);
 	}
 
 	float Matte::get_diffuse_strength() const
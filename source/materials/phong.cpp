@@ -17,32 +17,31 @@ namespace poly::material
 		m_type	   = poly::structures::InteractionType::ABSORB;
 	}
 
-	Colour Phong::shade(poly::structures::SurfaceInteraction& sr,
-						poly::structures::World const& world) const
+	Colour Phong::shade_ambient(poly::structures::SurfaceInteraction& sr,
+								poly::structures::World const& world) const
 	{
-		// Render loop
-		Colour r = Colour(0.0f, 0.0f, 0.0f);
-		Colour a = Colour(0.0f, 0.0f, 0.0f);
 		atlas::math::Vector nullVec(0.0f, 0.0f, 0.0f);
-
 		if (world.m_ambient) {
-			a = m_diffuse->rho(sr, nullVec) * world.m_ambient->L(sr, world);
+			return m_diffuse->rho(sr, nullVec) * world.m_ambient->L(sr, world);
 		}
+		return Colour(0.0f, 0.0f, 0.0f);
+	}
 
-		math::Vector w_o = -sr.m_ray.d;
-		for (std::shared_ptr<poly::light::Light> light : world.m_lights) {
-			Colour L		 = light->L(sr, world);
-			math::Vector w_i = light->get_direction(sr);
+	Colour Phong::shade_light(poly::structures::SurfaceInteraction const& sr,
+							  atlas::math::Vector const& w_i,
+							  Colour const& L) const
+	{
+		atlas::math::Vector nullVec(0.0f, 0.0f, 0.0f);
+		math::Vector w_o	  = -sr.m_ray.d;
+		math::Vector incoming = w_i;
 
-			float angle = glm::dot(sr.m_normal, w_i);
-			if (angle >= 0) {
-				r += ((m_diffuse->f(sr, nullVec, nullVec) +
-					   m_specular->f(sr, w_o, w_i)) *
-					  L * angle);
-			}
+		float angle = glm::dot(sr.m_normal, w_i);
+		if (angle >= 0) {
+			return ((m_diffuse->f(sr, nullVec, nullVec) +
+					 m_specular->f(sr, w_o, incoming)) *
+					L * angle);
 		}
-
-		return (a + r);
+		return Colour(0.0f, 0.0f, 0.0f);
 	}
 
 	float Phong::get_diffuse_strength() const
@@ -20,10 +20,9 @@ namespace poly::material
 		m_type = poly::structures::InteractionType::REFLECT;
 	}
 
-	Colour Reflective::shade(poly::structures::SurfaceInteraction& sr,
-							 poly::structures::World const& world) const
+	void Reflective::scatter(poly::structures::SurfaceInteraction const& sr,
+							 std::vector<ScatteredRay>& rays) const
 	{
-		Colour L		 = Phong::shade(sr, world);
 		math::Vector w_o = -sr.m_ray.d;
 		math::Vector w_r;
 
@@ -31,11 +30,9 @@ namespace poly::material
 		Colour reflected_colour = m_reflected_brdf->sample_f(sr, w_o, w_r);
 		math::Ray<math::Vector> reflected_ray(sr.get_hitpoint(), w_r);
 
-		L += reflected_colour *
-			 world.m_tracer->trace_ray(reflected_ray, world, sr.depth + 1) *
-			 (float)fabs(glm::dot(sr.m_normal, w_r));
-
-		return L;
+		rays.push_back(
+			{reflected_ray,
+			 reflected_colour * (float)fabs(glm::dot(sr.m_normal, w_r))});
 	}
 
 	float Reflective::get_diffuse_strength() const
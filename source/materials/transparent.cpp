@@ -32,10 +32,9 @@ namespace poly::material
 		return m_transmitted_btdf->sample_f(sr, w_o, w_t);
 	}
 
-	Colour Transparent::shade(poly::structures::SurfaceInteraction& sr,
-							  poly::structures::World const& world) const
+	void Transparent::scatter(poly::structures::SurfaceInteraction const& sr,
+							  std::vector<ScatteredRay>& rays) const
 	{
-		Colour L		 = Phong::shade(sr, world);
 		math::Vector w_o = -sr.m_ray.d;
 		math::Vector w_r;
 
@@ -45,24 +44,21 @@ namespace poly::material
 
 		// If we have internal reflection, then the ray does not transmit
 		if (m_transmitted_btdf->tot_int_refl(sr)) {
-			L += world.m_tracer->trace_ray(reflected_ray, world, sr.depth + 1);
+			rays.push_back({reflected_ray, Colour(1.0f, 1.0f, 1.0f)});
 		}
 		else {
-			L += reflected_colour *
-				 world.m_tracer->trace_ray(reflected_ray, world, sr.depth + 1) *
-				 (float)fabs(glm::dot(sr.m_normal, w_r));
+			rays.push_back(
+				{reflected_ray,
+				 reflected_colour * (float)fabs(glm::dot(sr.m_normal, w_r))});
 
 			math::Vector w_t;
 			Colour transmitted_colour =
 				m_transmitted_btdf->sample_f(sr, w_o, w_t);
 			math::Ray<math::Vector> transmitted_ray(sr.get_hitpoint(), w_t);
-			L += transmitted_colour *
-				 world.m_tracer->trace_ray(
-					 transmitted_ray, world, sr.depth + 1) *
-				 (float)fabs(glm::dot(sr.m_normal, w_t));
+			rays.push_back(
+				{transmitted_ray,
+				 transmitted_colour * (float)fabs(glm::dot(sr.m_normal, w_t))});
 		}
-
-		return L;
 	}
 
 	float Transparent::get_diffuse_strength() const
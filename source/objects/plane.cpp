@@ -28,9 +28,9 @@ namespace poly::object
 			// Create the bounds
 			bounds = poly::structures::Bounds3D(
 				math::Vector(
-					std::numeric_limits<float>::min(),
-					std::numeric_limits<float>::min(),
-					std::numeric_limits<float>::min()),
+					std::numeric_limits<float>::lowest(),
+					std::numeric_limits<float>::lowest(),
+					std::numeric_limits<float>::lowest()),
 				math::Vector(
 					std::numeric_limits<float>::max(),
 					std::numeric_limits<float>::max(),
@@ -71,15 +71,19 @@ namespace poly::object
 		// If this object is hit, set the SurfaceInteraction with the relevant material and information about the hit point
 		if (intersect && t < sr.m_tmin)
 		{
-			sr.m_normal = normal; // Override
-			sr.m_ray = R;
 			sr.m_tmin = t;
-			sr.m_material = m_material;
+			sr.m_object = this;
 		}
 
 		return intersect;
 	}
 
+	void Plane::interaction_resolve(poly::structures::SurfaceInteraction &sr) const
+	{
+		sr.m_normal = normal; // Override
+		sr.m_material = m_material.get();
+	}
+
 	bool Plane::shadow_hit([[maybe_unused]] math::Ray<math::Vector> const &R,
 						   [[maybe_unused]] float &t) const
 	{
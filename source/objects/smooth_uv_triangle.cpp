@@ -84,27 +84,33 @@ namespace poly::object {
 		// If this object is hit, set the SurfaceInteraction with the relevant material and information about the hit point
 		if (t < sr.m_tmin)
 		{
-			sr.m_ray = R;
 			sr.m_tmin = t;
-			sr.m_material = m_material;
-			if (m_uvs.size() == 3)
-			{
-				sr.m_u = interpolate_u(beta, gamma);
-				sr.m_v = interpolate_v(beta, gamma);
-			}
-			if (m_normals.size() == 3)
-			{
-				sr.m_normal = interpolate_norm(beta, gamma);
-			}
-			else
-			{
-				sr.m_normal = get_normal(); // Override
-			}
+			sr.m_object = this;
+			sr.m_beta = beta;
+			sr.m_gamma = gamma;
 		}
 
 		return true;
 	}
 
+	void SmoothMeshUVTriangle::interaction_resolve(poly::structures::SurfaceInteraction &sr) const
+	{
+		sr.m_material = m_material.get();
+		if (m_uvs.size() == 3)
+		{
+			sr.m_u = interpolate_u(sr.m_beta, sr.m_gamma);
+			sr.m_v = interpolate_v(sr.m_beta, sr.m_gamma);
+		}
+		if (m_normals.size() == 3)
+		{
+			sr.m_normal = interpolate_norm(sr.m_beta, sr.m_gamma);
+		}
+		else
+		{
+			sr.m_normal = get_normal(); // Override
+		}
+	}
+
 	math::Vector SmoothMeshUVTriangle::interpolate_norm(float &beta, float &gamma) const
 	{
 		return (1 - beta - gamma) * m_normals.at(0) + (beta * m_normals.at(1)) + (gamma * m_normals.at(2));
@@ -42,15 +42,19 @@ namespace poly::object {
 
 		// If this object is hit, set the SurfaceInteraction with the relevant material and information about the hit point
 		if (intersect && t < sr.m_tmin) {
-			sr.m_normal = get_normal(R, t);
-			sr.m_ray = R;
 			sr.m_tmin = t;
-			sr.m_material = m_material;
+			sr.m_object = this;
 		}
 
 		return intersect;
 	}
 
+	void Sphere::interaction_resolve(poly::structures::SurfaceInteraction& sr) const
+	{
+		sr.m_normal = get_normal(sr.m_ray, sr.m_tmin);
+		sr.m_material = m_material.get();
+	}
+
 	bool Sphere::shadow_hit(math::Ray<math::Vector>const& R,
 		float& t) const
 	{
@@ -77,15 +77,19 @@ namespace poly::object {
 		// If this object is hit, set the SurfaceInteraction with the relevant material and information about the hit point
 		if (intersect && t < sr.m_tmin)
 		{
-			sr.m_normal = normal_get(R, t);
-			sr.m_ray = R;
 			sr.m_tmin = t;
-			sr.m_material = m_material;
+			sr.m_object = this;
 		}
 
 		return intersect;
 	}
 
+	void Torus::interaction_resolve(poly::structures::SurfaceInteraction& sr) const
+	{
+		sr.m_normal = normal_get(sr.m_ray, sr.m_tmin);
+		sr.m_material = m_material.get();
+	}
+
 	bool Torus::shadow_hit(math::Ray<math::Vector> const& R,
 		float& t) const
 	{
@@ -0,0 +1,54 @@
+#include "samplers/blue_noise.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace poly::sampler
+{
+	// Generalised golden ratio for two dimensions (the plastic constant)
+	static constexpr double r2_a1 = 1.0 / 1.32471795724474602596;
+	static constexpr double r2_a2 = r2_a1 * r2_a1;
+
+	// Largest float below 1, keeps the shifted samples in [0, 1)
+	static constexpr float one_minus_epsilon = 0x1.fffffep-1f;
+
+	static float fractional(double value)
+	{
+		return std::min(static_cast<float>(value - std::floor(value)),
+						one_minus_epsilon);
+	}
+
+	AA_BlueNoise::AA_BlueNoise()
+	{}
+
+	AA_BlueNoise::AA_BlueNoise(unsigned int num_samp)
+	{
+		num_samples = num_samp;
+		num_sets	= 1;
+	}
+
+	void AA_BlueNoise::generate_samples()
+	{
+		// Samples are computed on demand
+	}
+
+	/**
+	Computes a sample of a pixel. The index picks a point of the R2 sequence,
+	which is then rotated toroidally by the pixel's value in the R2 dither
+	mask. The mask is a single value per pixel, so the sets of neighbouring
+	pixels are rotations of each other rather than the same points with the
+	indices shifted
+
+	@param x the pixel column
+	@param y the pixel row
+	@param index the sample number within the pixel
+
+	@returns the sample in [0, 1)^2
+	*/
+	atlas::math::Vector2
+	AA_BlueNoise::sample_pixel(int x, int y, const unsigned int index) const
+	{
+		double mask = fractional(r2_a1 * x + r2_a2 * y);
+		return {fractional(0.5 + r2_a1 * index + mask),
+				fractional(0.5 + r2_a2 * index + mask)};
+	}
+} // namespace poly::sampler
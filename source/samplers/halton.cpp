@@ -0,0 +1,66 @@
+#include "samplers/halton.hpp"
+#include "utilities/random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace poly::sampler
+{
+	// Largest float below 1, keeps the shifted samples in [0, 1)
+	static constexpr float one_minus_epsilon = 0x1.fffffep-1f;
+
+	static double radical_inverse(unsigned int base, unsigned int index)
+	{
+		double inverse_base = 1.0 / base;
+		double factor		= inverse_base;
+		double result		= 0.0;
+		while (index > 0) {
+			result += factor * (index % base);
+			index /= base;
+			factor *= inverse_base;
+		}
+		return result;
+	}
+
+	AA_Halton::AA_Halton()
+	{}
+
+	AA_Halton::AA_Halton(unsigned int num_samp)
+	{
+		num_samples = num_samp;
+		num_sets	= 1;
+	}
+
+	void AA_Halton::generate_samples()
+	{
+		// Samples are computed on demand
+	}
+
+	/**
+	Computes a sample of a pixel as the Halton point of the index, toroidally
+	shifted by an offset hashed from the pixel
+
+	@param x the pixel column
+	@param y the pixel row
+	@param index the sample number within the pixel
+
+	@returns the sample in [0, 1)^2
+	*/
+	atlas::math::Vector2
+	AA_Halton::sample_pixel(int x, int y, const unsigned int index) const
+	{
+		std::uint64_t seed = poly::utils::mix_bits(
+			poly::utils::random_seed() ^
+			(static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32u |
+			 static_cast<std::uint32_t>(y)));
+		double shift_u = static_cast<double>(seed >> 40u) / 16777216.0;
+		double shift_v =
+			static_cast<double>((seed >> 8u) & 0xffffffu) / 16777216.0;
+
+		double u = radical_inverse(2, index) + shift_u;
+		double v = radical_inverse(3, index) + shift_v;
+		return {
+			std::min(static_cast<float>(u - std::floor(u)), one_minus_epsilon),
+			std::min(static_cast<float>(v - std::floor(v)), one_minus_epsilon)};
+	}
+} // namespace poly::sampler
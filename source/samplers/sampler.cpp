@@ -0,0 +1,27 @@
+#include <math.h>
+#include "samplers/sampler.hpp"
+#include "utilities/utilities.hpp"
+
+namespace poly::sampler
+{
+	void Sampler::map_samples_to_hemisphere(const float e)
+	{
+		std::size_t size = get_num_samples();
+		hemisphere_samples.clear();
+		hemisphere_samples.reserve(size);
+		for (std::size_t i = 0; i < size; i++)
+		{
+			atlas::math::Vector2 sample = sample_unit_square((unsigned int)i);
+			float cos_phi = static_cast<float>(cos(2.0f * poly::utils::pi<float> * sample.x));
+			float sin_phi = static_cast<float>(sin(2.0f * poly::utils::pi<float> * sample.x));
+			float cos_theta = static_cast<float>(pow(1.0f - sample.y, (1.0f / (e + 1.0f))));
+			float sin_theta = static_cast<float>(sqrt(1.0f - (cos_theta * cos_theta)));
+			float pu = sin_theta * cos_phi;
+			float pv = sin_theta * sin_phi;
+			float pw = cos_theta;
+			
+
+			hemisphere_samples.emplace_back(pu, pv, pw);
+		}
+	}
+} // namespace poly::sampler
@@ -0,0 +1,96 @@
+#include "samplers/sobol.hpp"
+#include "utilities/random.hpp"
+#include <cstdint>
+
+namespace poly::sampler
+{
+	static std::uint32_t reverse_bits(std::uint32_t x)
+	{
+		x = ((x >> 1u) & 0x55555555u) | ((x & 0x55555555u) << 1u);
+		x = ((x >> 2u) & 0x33333333u) | ((x & 0x33333333u) << 2u);
+		x = ((x >> 4u) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4u);
+		x = ((x >> 8u) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8u);
+		return (x >> 16u) | (x << 16u);
+	}
+
+	/**
+	Owen scrambles the bits of x, applied from the most significant bit down.
+	The hash only lets lower bits depend on higher ones (Laine and Karras), so
+	on reversed bits it acts as a nested uniform scramble
+
+	@param x the value to scramble
+	@param seed selects the scramble
+
+	@returns the scrambled value
+	*/
+	static std::uint32_t owen_scramble(std::uint32_t x, std::uint32_t seed)
+	{
+		x = reverse_bits(x);
+		x += seed;
+		x ^= x * 0x6c50b47cu;
+		x ^= x * 0xb82f1e52u;
+		x ^= x * 0xc7afe638u;
+		x ^= x * 0x8d22f6e6u;
+		return reverse_bits(x);
+	}
+
+	// Second Sobol dimension, direction numbers of x + 1
+	static std::uint32_t sobol_dimension_1(std::uint32_t index)
+	{
+		std::uint32_t result{0};
+		for (std::uint32_t v{1u << 31u}; index != 0; index >>= 1u, v ^= v >> 1u) {
+			if (index & 1u) {
+				result ^= v;
+			}
+		}
+		return result;
+	}
+
+	static float to_unit_float(std::uint32_t x)
+	{
+		return static_cast<float>(x >> 8u) * (1.0f / 16777216.0f);
+	}
+
+	AA_Sobol::AA_Sobol()
+	{}
+
+	AA_Sobol::AA_Sobol(unsigned int num_samp)
+	{
+		num_samples = num_samp;
+		num_sets	= 1;
+	}
+
+	void AA_Sobol::generate_samples()
+	{
+		// Samples are computed on demand
+	}
+
+	/**
+	Computes a sample of a pixel. The index is shuffled and both dimensions
+	scrambled with seeds from the pixel, which keeps each pixel's points
+	stratified while decorrelating neighbours
+
+	@param x the pixel column
+	@param y the pixel row
+	@param index the sample number within the pixel
+
+	@returns the sample in [0, 1)^2
+	*/
+	atlas::math::Vector2
+	AA_Sobol::sample_pixel(int x, int y, const unsigned int index) const
+	{
+		std::uint64_t seed = poly::utils::mix_bits(
+			poly::utils::random_seed() ^
+			(static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32u |
+			 static_cast<std::uint32_t>(y)));
+
+		std::uint32_t shuffled =
+			owen_scramble(index, static_cast<std::uint32_t>(seed));
+		std::uint32_t u = owen_scramble(
+			reverse_bits(shuffled), static_cast<std::uint32_t>(seed >> 32u));
+		std::uint32_t v = owen_scramble(
+			sobol_dimension_1(shuffled),
+			static_cast<std::uint32_t>(poly::utils::mix_bits(seed)));
+		return {to_unit_float(u), to_unit_float(v)};
+	}
+} // namespace poly::sampler
@@ -353,6 +353,23 @@ namespace poly::structures
 		return m_bounds;
 	}
 
+	/**
+	The primitives in the leaves record themselves as the closest hit, so the
+	tree is never asked to resolve an interaction
+
+	@param sr the interaction to resolve
+	*/
+	void KDTree::interaction_resolve([[maybe_unused]] SurfaceInteraction &sr) const
+	{}
+
+	void KDTree::append_primitives(
+		std::vector<poly::object::Object const *> &primitives) const
+	{
+		for (auto const &object : objects) {
+			object->append_primitives(primitives);
+		}
+	}
+
 	Bounds3D KDTree::union_bounds(Bounds3D const &b1, Bounds3D const &b2)
 	{
 		return Bounds3D(math::Vector(std::min(b1.pMin.x, b2.pMin.x),
@@ -586,12 +603,12 @@ namespace poly::structures
 		return hit;
 	}
 
-	std::vector<std::shared_ptr<poly::object::Object>>
+	std::vector<poly::object::Object *>
 	KDTree::get_nearest_to_point(atlas::math::Point const &hitpoint,
 								 float radius_to_check,
 								 std::size_t max_num_points) const
 	{
-		std::vector<std::shared_ptr<poly::object::Object>> nearest_objects;
+		std::vector<poly::object::Object *> nearest_objects;
 
 		// First, check if we are inside the box at all
 		// double tMin, tMax;
@@ -658,7 +675,7 @@ namespace poly::structures
 					const std::shared_ptr<Object> &obj =
 						objects.at(node->onePrimitive);
 					if (obj->hit(ray, sr)) {
-						nearest_objects.push_back(obj);
+						nearest_objects.push_back(obj.get());
 					}
 				}
 				else {
@@ -668,7 +685,7 @@ namespace poly::structures
 						const std::shared_ptr<Object> &obj = objects.at(index);
 						if (obj->hit(ray, sr) &&
 							nearest_objects.size() < max_num_points) {
-							nearest_objects.push_back(obj);
+							nearest_objects.push_back(obj.get());
 						}
 					}
 				}
@@ -0,0 +1,132 @@
+#include "structures/framebuffer.hpp"
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <thread>
+
+namespace poly::structures
+{
+	static constexpr int block_untouched = 0;
+	static constexpr int block_clearing	 = 1;
+	static constexpr int block_ready	 = 2;
+
+	static constexpr std::size_t block_bytes =
+		Framebuffer::block_size * Framebuffer::block_size *
+		sizeof(atlas::math::Vector);
+	static_assert(block_bytes % Framebuffer::page_size == 0,
+				  "framebuffer blocks must span whole pages");
+
+	Framebuffer::Framebuffer(int width, int height) :
+		m_width{width},
+		m_height{height},
+		m_blocks_x{(width + block_size - 1) / block_size},
+		m_pixels{},
+		m_block_state{}
+	{
+		// Default-initialised, the pages are only allocated once touched
+		std::size_t count = block_count() * block_size * block_size;
+		auto pixels = static_cast<atlas::math::Vector*>(::operator new(
+			count * sizeof(atlas::math::Vector), std::align_val_t{page_size}));
+		std::uninitialized_default_construct_n(pixels, count);
+		m_pixels.reset(pixels);
+		m_block_state.reset(new std::atomic<int>[block_count()]());
+	}
+
+	/**
+	Clears every block overlapping the given pixels the first time any thread
+	asks for it. A block is cleared exactly once and always before pixels are
+	written to it, so slabs sharing a block can be prepared and rendered by
+	different threads in any order
+
+	@param x0 the first column
+	@param y0 the first row, 0 being the top of the image
+	@param x1 one past the last column
+	@param y1 one past the last row
+	*/
+	void Framebuffer::prepare(int x0, int y0, int x1, int y1)
+	{
+		x0 = std::max(x0, 0);
+		y0 = std::max(y0, 0);
+		x1 = std::min(x1, m_width);
+		y1 = std::min(y1, m_height);
+		if (x0 >= x1 || y0 >= y1) {
+			return;
+		}
+
+		for (int by{y0 / block_size}; by <= (y1 - 1) / block_size; ++by) {
+			for (int bx{x0 / block_size}; bx <= (x1 - 1) / block_size; ++bx) {
+				std::size_t block = static_cast<std::size_t>(by * m_blocks_x + bx);
+				std::atomic<int>& state = m_block_state[block];
+
+				int expected = block_untouched;
+				if (state.compare_exchange_strong(expected,
+												  block_clearing,
+												  std::memory_order_acquire)) {
+					std::fill_n(m_pixels.get() + block * block_size * block_size,
+								block_size * block_size,
+								atlas::math::Vector{0.0f, 0.0f, 0.0f});
+					state.store(block_ready, std::memory_order_release);
+				}
+				else {
+					// Another thread is clearing it, wait until it is done
+					while (state.load(std::memory_order_acquire) != block_ready) {
+						std::this_thread::yield();
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	Converts the blocked layout to a row-major image in a single pass
+
+	@param image the destination, resized to width * height
+	*/
+	void Framebuffer::resolve(std::vector<atlas::math::Vector>& image) const
+	{
+		image.resize(static_cast<std::size_t>(m_width) *
+					 static_cast<std::size_t>(m_height));
+
+		// Each block row is contiguous, copy it in one go
+		auto out = image.begin();
+		for (int y{0}; y < m_height; ++y) {
+			for (int x{0}; x < m_width; x += block_size) {
+				int count = std::min(block_size, m_width - x);
+				std::size_t block =
+					static_cast<std::size_t>((y / block_size) * m_blocks_x +
+											 (x / block_size));
+				if (m_block_state[block].load(std::memory_order_acquire) !=
+					block_ready) {
+					out = std::fill_n(
+						out, count, atlas::math::Vector{0.0f, 0.0f, 0.0f});
+					continue;
+				}
+				auto first = m_pixels.get() + index(x, y);
+				out		   = std::copy(first, first + count, out);
+			}
+		}
+	}
+
+	void Framebuffer::PageDeleter::operator()(atlas::math::Vector* pixels) const
+	{
+		// Vectors are trivially destructible, only the storage is released
+		::operator delete(pixels, std::align_val_t{page_size});
+	}
+
+	int Framebuffer::width() const
+	{
+		return m_width;
+	}
+
+	int Framebuffer::height() const
+	{
+		return m_height;
+	}
+
+	std::size_t Framebuffer::block_count() const
+	{
+		return static_cast<std::size_t>(m_blocks_x) *
+			   static_cast<std::size_t>((m_height + block_size - 1) /
+										block_size);
+	}
+} // namespace poly::structures
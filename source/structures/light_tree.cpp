@@ -0,0 +1,208 @@
+#include "structures/light_tree.hpp"
+#include "lights/light.hpp"
+#include <algorithm>
+
+namespace poly::structures
+{
+	// Keeps the importance of a point sitting on a light finite
+	static constexpr float min_distance_squared = 1.0e-4f;
+
+	// Largest float below 1, rescaled draws are clamped to it
+	static constexpr float one_minus_epsilon = 0x1.fffffep-1f;
+
+	/**
+	Builds the tree over the lights that have a position, splitting each node
+	at the median along the widest axis of its lights
+
+	@param lights the lights of the world, indexed by the samples
+	*/
+	LightTree::LightTree(
+		std::vector<std::shared_ptr<poly::light::Light>> const& lights)
+	{
+		std::vector<std::uint32_t> placed;
+		for (std::uint32_t l{0}; l < lights.size(); ++l) {
+			if (lights[l]->has_position()) {
+				placed.push_back(l);
+			}
+			else {
+				m_unplaced.push_back(l);
+			}
+		}
+
+		if (!placed.empty()) {
+			m_nodes.reserve(2 * placed.size() - 1);
+			build(lights, placed, 0, placed.size());
+		}
+	}
+
+	/**
+	@param lights the lights of the world
+	@param order the indices of the lights to place, reordered in place
+	@param first the first index of this node's lights in order
+	@param last one past the last index of this node's lights in order
+
+	@returns the index of the new node
+	*/
+	std::uint32_t LightTree::build(
+		std::vector<std::shared_ptr<poly::light::Light>> const& lights,
+		std::vector<std::uint32_t>& order,
+		std::size_t first,
+		std::size_t last)
+	{
+		std::uint32_t index = static_cast<std::uint32_t>(m_nodes.size());
+		m_nodes.emplace_back();
+
+		if (last - first == 1) {
+			poly::light::Light const& light = *lights[order[first]];
+			atlas::math::Point position = light.location();
+			m_nodes[index] = {
+				Bounds3D(position, position), light.power(), order[first], 0, true};
+			return index;
+		}
+
+		atlas::math::Vector lower = lights[order[first]]->location();
+		atlas::math::Vector upper = lower;
+		float power{0.0f};
+		for (std::size_t i{first}; i < last; ++i) {
+			lower = glm::min(lower, lights[order[i]]->location());
+			upper = glm::max(upper, lights[order[i]]->location());
+			power += lights[order[i]]->power();
+		}
+		Bounds3D bounds(lower, upper);
+
+		int axis		 = bounds.maximum_extent();
+		std::size_t mid = (first + last) / 2;
+		std::nth_element(order.begin() + first,
+						 order.begin() + mid,
+						 order.begin() + last,
+						 [&lights, axis](std::uint32_t a, std::uint32_t b) {
+							 return lights[a]->location()[axis] <
+									lights[b]->location()[axis];
+						 });
+
+		build(lights, order, first, mid);
+		std::uint32_t second = build(lights, order, mid, last);
+		m_nodes[index]		 = {bounds, power, 0, second, false};
+		return index;
+	}
+
+	/**
+	Estimates how much light a node may send to a point: its power over the
+	squared distance to its centre. Points inside the node use its radius
+	instead, since any of its lights may be right next to them
+
+	@param node the node to rate
+	@param point the shading point
+
+	@returns the unnormalised probability of walking into node
+	*/
+	float LightTree::importance(Node const& node,
+								atlas::math::Point const& point) const
+	{
+		atlas::math::Vector centre = 0.5f * (node.bounds.pMin + node.bounds.pMax);
+		atlas::math::Vector radius = 0.5f * node.bounds.diagonal();
+		float distance_squared	   = glm::dot(point - centre, point - centre);
+		float radius_squared	   = glm::dot(radius, radius);
+		return node.power / std::max({distance_squared,
+									  radius_squared,
+									  min_distance_squared});
+	}
+
+	/**
+	Walks the tree once per pick. Each pick is weighted by one over its
+	probability and the number of picks, so the expected sum equals shading
+	from every light in the tree
+
+	@param point the shading point
+	@param count the number of lights to pick from the tree
+	@param rng the generator of the shading point
+	@param samples cleared, then filled with the lights to shade from
+	*/
+	void LightTree::sample(atlas::math::Point const& point,
+						   unsigned int count,
+						   poly::utils::Random& rng,
+						   std::vector<LightSample>& samples) const
+	{
+		samples.clear();
+		for (std::uint32_t light : m_unplaced) {
+			samples.push_back({light, 1.0f});
+		}
+		if (m_nodes.empty()) {
+			return;
+		}
+
+		for (unsigned int pick{0}; pick < count; ++pick) {
+			float u	  = rng.uniform();
+			float pdf = 1.0f;
+			std::uint32_t index{0};
+			while (!m_nodes[index].leaf) {
+				std::uint32_t second = m_nodes[index].second_child;
+				float first_importance  = importance(m_nodes[index + 1], point);
+				float second_importance = importance(m_nodes[second], point);
+				float total				= first_importance + second_importance;
+				float p_first = total > 0.0f ? first_importance / total : 0.5f;
+
+				// Reuse the draw, rescaled to the branch taken
+				if (u < p_first) {
+					u /= p_first;
+					pdf *= p_first;
+					index += 1;
+				}
+				else {
+					u = (u - p_first) / (1.0f - p_first);
+					pdf *= 1.0f - p_first;
+					index = second;
+				}
+				u = std::min(u, one_minus_epsilon);
+			}
+
+			std::uint32_t light = m_nodes[index].light;
+			float weight		= 1.0f / (static_cast<float>(count) * pdf);
+			auto merged			= std::find_if(
+				samples.begin() + m_unplaced.size(),
+				samples.end(),
+				[light](LightSample const& sample) { return sample.light == light; });
+			if (merged != samples.end()) {
+				merged->weight += weight;
+			}
+			else {
+				samples.push_back({light, weight});
+			}
+		}
+	}
+
+	/**
+	@param u the draw in [0, 1)
+	@param pdf set to the probability of the light returned
+
+	@returns the index of the picked light in the world's lights
+	*/
+	std::uint32_t LightTree::sample_power(float u, float& pdf) const
+	{
+		pdf = 1.0f;
+		std::uint32_t index{0};
+		while (!m_nodes[index].leaf) {
+			std::uint32_t second = m_nodes[index].second_child;
+			float total			 = m_nodes[index].power;
+			float p_first		 = total > 0.0f ? m_nodes[index + 1].power / total
+												: 0.5f;
+			if (u < p_first) {
+				u /= p_first;
+				pdf *= p_first;
+				index += 1;
+			}
+			else {
+				u = (u - p_first) / (1.0f - p_first);
+				pdf *= 1.0f - p_first;
+				index = second;
+			}
+			u = std::min(u, one_minus_epsilon);
+		}
+		return m_nodes[index].light;
+	}
+
+	std::size_t LightTree::size() const
+	{
+		return m_nodes.empty() ? 0 : (m_nodes.size() + 1) / 2;
+	}
+} // namespace poly::structures
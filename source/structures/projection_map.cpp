@@ -0,0 +1,176 @@
+#include "structures/projection_map.hpp"
+#include "materials/material.hpp"
+#include "utilities/utilities.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace poly::structures
+{
+	// Bounds wider than this (planes) would mark the whole sphere
+	static constexpr float max_marked_extent = 1.0e6f;
+
+	/**
+	Builds the projection map of a light by marking every cell whose cone of
+	directions may hit the bounds of a reflective or transparent object
+
+	@param origin the position of the light
+	@param scene the objects of the world
+	@param theta_cells the number of cells along cos(theta)
+	@param phi_cells the number of cells along phi
+	*/
+	ProjectionMap::ProjectionMap(
+		atlas::math::Point const& origin,
+		std::vector<std::shared_ptr<poly::object::Object>> const& scene,
+		int theta_cells,
+		int phi_cells) :
+		m_theta_cells{std::max(theta_cells, 1)},
+		m_phi_cells{std::max(phi_cells, 1)},
+		m_marked(static_cast<std::size_t>(m_theta_cells * m_phi_cells), false)
+	{
+		for (auto const& object : scene) {
+			std::shared_ptr<poly::material::Material> material =
+				object->material_get();
+			if (!material || (material->get_reflective_strength() <= 0.0f &&
+							  material->get_refractive_strength() <= 0.0f)) {
+				continue;
+			}
+
+			Bounds3D bounds			 = object->get_boundbox();
+			atlas::math::Vector size = bounds.diagonal();
+			if (!(size.x < max_marked_extent && size.y < max_marked_extent &&
+				  size.z < max_marked_extent)) {
+				continue;
+			}
+
+			mark(origin, bounds);
+		}
+
+		for (int cell{0}; cell < m_theta_cells * m_phi_cells; ++cell) {
+			if (m_marked[static_cast<std::size_t>(cell)]) {
+				m_marked_cells.push_back(cell);
+			}
+			else {
+				m_unmarked_cells.push_back(cell);
+			}
+		}
+	}
+
+	float ProjectionMap::coverage() const
+	{
+		return static_cast<float>(m_marked_cells.size()) /
+			   static_cast<float>(m_marked.size());
+	}
+
+	atlas::math::Vector
+	ProjectionMap::sample_marked(poly::utils::Random& rng) const
+	{
+		return sample_cell(
+			m_marked_cells[rng.uniform(
+				static_cast<std::uint32_t>(m_marked_cells.size()))],
+			rng);
+	}
+
+	atlas::math::Vector
+	ProjectionMap::sample_unmarked(poly::utils::Random& rng) const
+	{
+		return sample_cell(
+			m_unmarked_cells[rng.uniform(
+				static_cast<std::uint32_t>(m_unmarked_cells.size()))],
+			rng);
+	}
+
+	/**
+	Marks the cells overlapping the cone that bounds the sphere around the given
+	box. The cone is widened to its (theta, phi) rectangle, so the marking is
+	conservative
+
+	@param origin the position of the light
+	@param bounds the bounding box of a specular object
+	*/
+	void ProjectionMap::mark(atlas::math::Point const& origin,
+							 Bounds3D const& bounds)
+	{
+		atlas::math::Point centre = (bounds.pMin + bounds.pMax) * 0.5f;
+		float radius			  = glm::length(bounds.diagonal()) * 0.5f;
+		atlas::math::Vector to_centre = centre - origin;
+		float distance				  = glm::length(to_centre);
+
+		// The light sits inside the object, every direction may hit it
+		if (distance <= radius) {
+			std::fill(m_marked.begin(), m_marked.end(), true);
+			return;
+		}
+
+		atlas::math::Vector direction = to_centre / distance;
+		float half_angle			  = std::asin(radius / distance);
+		float theta = std::acos(std::clamp(direction.z, -1.0f, 1.0f));
+		float phi	= std::atan2(direction.y, direction.x);
+
+		float theta_low	 = theta - half_angle;
+		float theta_high = theta + half_angle;
+
+		// Rows are uniform in cos(theta), which decreases with theta
+		auto row_of = [this](float cos_theta) {
+			int row = static_cast<int>(
+				std::floor((cos_theta + 1.0f) * 0.5f * m_theta_cells));
+			return std::clamp(row, 0, m_theta_cells - 1);
+		};
+		int row_low =
+			row_of(std::cos(std::min(theta_high, poly::utils::pi<float>)));
+		int row_high = row_of(std::cos(std::max(theta_low, 0.0f)));
+
+		// A cone around a pole covers every phi
+		int column_low	= 0;
+		int column_high = m_phi_cells - 1;
+		if (theta_low > 0.0f && theta_high < poly::utils::pi<float>) {
+			float half_phi = std::asin(
+				std::min(std::sin(half_angle) / std::sin(theta), 1.0f));
+			float cells_per_radian =
+				m_phi_cells / (2.0f * poly::utils::pi<float>);
+			int low = static_cast<int>(
+				std::floor((phi - half_phi) * cells_per_radian));
+			int high = static_cast<int>(
+				std::floor((phi + half_phi) * cells_per_radian));
+			if (high - low < m_phi_cells) {
+				column_low	= low;
+				column_high = high;
+			}
+		}
+
+		for (int row{row_low}; row <= row_high; ++row) {
+			for (int column{column_low}; column <= column_high; ++column) {
+				int wrapped = ((column % m_phi_cells) + m_phi_cells) %
+							  m_phi_cells;
+				m_marked[static_cast<std::size_t>(row * m_phi_cells +
+												  wrapped)] = true;
+			}
+		}
+	}
+
+	/**
+	Samples a direction uniformly within a cell. Since every cell spans the same
+	range of cos(theta) and phi, this is uniform in solid angle
+
+	@param cell the index of the cell (row * phi_cells + column)
+
+	@returns a unit direction
+	*/
+	atlas::math::Vector
+	ProjectionMap::sample_cell(int cell, poly::utils::Random& rng) const
+	{
+		int row	   = cell / m_phi_cells;
+		int column = cell % m_phi_cells;
+
+		float cos_theta =
+			-1.0f + 2.0f * (static_cast<float>(row) + rng.uniform()) /
+						static_cast<float>(m_theta_cells);
+		float phi = 2.0f * poly::utils::pi<float> *
+					(static_cast<float>(column) + rng.uniform()) /
+					static_cast<float>(m_phi_cells);
+		float sin_theta =
+			std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+
+		return atlas::math::Vector{
+			sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta};
+	}
+} // namespace poly::structures
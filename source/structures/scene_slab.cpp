@@ -5,17 +5,16 @@
 namespace poly::structures
 {
 	scene_slab::scene_slab(
-		std::shared_ptr<World> _world,
-		std::shared_ptr<std::mutex> _storage_mutex,
-		std::shared_ptr<std::vector<std::vector<Colour>>> _storage,
+		World const* _world,
+		std::shared_ptr<Framebuffer> _framebuffer,
 		int _start_x,
 		int _end_x,
 		int _start_y,
 		int _end_y)
 	{
 		world		  = _world;
-		storage_mutex = _storage_mutex;
-		storage		  = _storage;
+		framebuffer	  = _framebuffer;
+		sample_counts = nullptr;
 		start_x		  = _start_x;
 		end_x		  = _end_x;
 		start_y		  = _start_y;
@@ -32,8 +31,7 @@ namespace poly::structures
 	@param end_y the ending y value
 	@param preferred_slab_size the prefferred slab dimension
 	@param world pointer to the world holding the scene information
-	@param storage_mutex to protect storage between threads
-	@param storage finalized pixel storage location
+	@param framebuffer finalized pixel storage location
 
 
 	@returns std::vector<std::shared_ptr<poly::structures::scene_slab>> list of
@@ -45,9 +43,8 @@ namespace poly::structures
 				   int start_y,
 				   int end_y,
 				   std::size_t preferred_slab_size,
-				   std::shared_ptr<poly::structures::World> world,
-				   std::shared_ptr<std::mutex> storage_mutex,
-				   std::shared_ptr<std::vector<std::vector<Colour>>> storage)
+				   poly::structures::World const* world,
+				   std::shared_ptr<Framebuffer> framebuffer)
 	{
 		// Initial slab dimensions
 		int slab_width	= static_cast<int>(preferred_slab_size);
@@ -81,8 +78,7 @@ namespace poly::structures
 				std::shared_ptr<poly::structures::scene_slab> new_ti =
 					std::make_shared<poly::structures::scene_slab>(
 						world,
-						storage_mutex,
-						storage,
+						framebuffer,
 						j,
 						j + slab_width,
 						i,
@@ -7,7 +7,11 @@ namespace poly::structures
 		m_u{},
 		m_v{},
 		m_material{nullptr},
+		m_object{nullptr},
+		m_beta{},
+		m_gamma{},
 		m_colour{atlas::math::Vector(0.0f, 0.0f, 0.0f)},
+		m_throughput{atlas::math::Vector(1.0f, 1.0f, 1.0f)},
 		m_normal{}
 	{
 		// Initial distance to max object is m_tmin
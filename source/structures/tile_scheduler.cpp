@@ -0,0 +1,282 @@
+#include "structures/tile_scheduler.hpp"
+#include <algorithm>
+#include <climits>
+#include <thread>
+
+namespace poly::structures
+{
+	/**
+	Orders the slabs along a Morton curve of their top-left corners and deals
+	them to the workers in contiguous runs, so that neighbouring slabs (and the
+	geometry they touch) tend to be rendered by the same thread
+
+	@param slabs the slabs to render
+	@param num_workers the number of threads that will call next()
+	@param min_slab_size slabs are not split below this edge length
+	@param worker_nodes the NUMA node of each worker, empty if unknown
+	*/
+	TileScheduler::TileScheduler(std::vector<std::shared_ptr<scene_slab>> slabs,
+								 std::size_t num_workers,
+								 int min_slab_size,
+								 std::vector<std::size_t> const& worker_nodes) :
+		m_queues{},
+		m_min_slab_size{std::max(min_slab_size, 1)},
+		m_total{slabs.size()},
+		m_remaining{slabs.size()},
+		m_completed{0}
+	{
+		num_workers = std::max<std::size_t>(num_workers, 1);
+		for (std::size_t i{0}; i < num_workers; ++i) {
+			m_queues.push_back(std::make_unique<WorkerQueue>());
+		}
+
+		// Steal from the workers sharing a node before crossing to another,
+		// both in order starting from the neighbouring worker
+		auto node = [&worker_nodes](std::size_t worker) {
+			return worker < worker_nodes.size() ? worker_nodes[worker] : 0;
+		};
+		m_victims.resize(num_workers);
+		m_claimed.assign(num_workers, false);
+		for (std::size_t worker{0}; worker < num_workers; ++worker) {
+			m_nodes.push_back(node(worker));
+		}
+		for (std::size_t worker{0}; worker < num_workers; ++worker) {
+			for (bool same_node : {true, false}) {
+				for (std::size_t offset{1}; offset < num_workers; ++offset) {
+					std::size_t victim = (worker + offset) % num_workers;
+					if ((node(victim) == node(worker)) == same_node) {
+						m_victims[worker].push_back(victim);
+					}
+				}
+			}
+		}
+
+		if (slabs.empty()) {
+			return;
+		}
+
+		// Grid coordinates of the slabs, relative to the first corner
+		int min_x{INT_MAX}, min_y{INT_MAX}, step{INT_MAX};
+		for (auto const& slab : slabs) {
+			min_x = std::min(min_x, slab->start_x);
+			min_y = std::min(min_y, slab->start_y);
+			step  = std::min(step,
+							 std::max(std::max(slab->end_x - slab->start_x,
+											   slab->end_y - slab->start_y),
+									  1));
+		}
+
+		std::vector<std::pair<std::uint32_t, std::shared_ptr<scene_slab>>>
+			ordered;
+		ordered.reserve(slabs.size());
+		for (auto& slab : slabs) {
+			ordered.emplace_back(
+				morton_code(static_cast<std::uint32_t>(
+								(slab->start_x - min_x) / step),
+							static_cast<std::uint32_t>(
+								(slab->start_y - min_y) / step)),
+				std::move(slab));
+		}
+		std::stable_sort(
+			ordered.begin(), ordered.end(), [](auto const& a, auto const& b) {
+				return a.first < b.first;
+			});
+
+		for (std::size_t i{0}; i < ordered.size(); ++i) {
+			std::size_t worker = i * num_workers / ordered.size();
+			m_queues[worker]->slabs.push_back(std::move(ordered[i].second));
+		}
+	}
+
+	/**
+	Gives a worker that is starting up a queue of its own. Pool threads pick
+	up workers in any order, so a worker may not run on the thread its index
+	was dealt for. It gets the preferred queue if that is free, else a free
+	queue on its own NUMA node, else any free queue
+
+	@param preferred the queue to take if free, e.g. the calling pool thread
+	@param node the NUMA node the caller runs on
+
+	@returns the worker index to pass to queued() and next()
+	*/
+	std::size_t TileScheduler::claim(std::size_t preferred, std::size_t node)
+	{
+		const std::lock_guard<std::mutex> lock(m_claim_mutex);
+		std::size_t chosen = m_queues.size();
+		if (preferred < m_queues.size() && !m_claimed[preferred]) {
+			chosen = preferred;
+		}
+		for (bool same_node : {true, false}) {
+			for (std::size_t queue{0};
+				 chosen == m_queues.size() && queue < m_queues.size();
+				 ++queue) {
+				if (!m_claimed[queue] && (m_nodes[queue] == node) == same_node) {
+					chosen = queue;
+				}
+			}
+		}
+
+		// More workers than queues, they have to share
+		if (chosen == m_queues.size()) {
+			return preferred % m_queues.size();
+		}
+		m_claimed[chosen] = true;
+		return chosen;
+	}
+
+	/**
+	Takes the next slab for a worker. Its own queue is used first, after which
+	the other queues are visited, those on the same NUMA node first
+
+	@param worker the index of the calling worker
+
+	@returns the slab to render, or nullptr if none are left
+	*/
+	std::shared_ptr<scene_slab> TileScheduler::next(std::size_t worker)
+	{
+		worker = worker % m_queues.size();
+
+		// Slabs taken by other workers count as remaining until their
+		// quarters are queued, so nobody leaves while a split is pending
+		while (m_remaining.load(std::memory_order_acquire) > 0) {
+			std::shared_ptr<scene_slab> slab = pop_front(worker);
+			for (std::size_t v{0}; !slab && v < m_victims[worker].size(); ++v) {
+				slab = steal(m_victims[worker][v]);
+			}
+
+			if (slab) {
+				slab = split(worker, std::move(slab));
+				m_remaining.fetch_sub(1, std::memory_order_release);
+				return slab;
+			}
+			std::this_thread::yield();
+		}
+		return nullptr;
+	}
+
+	void TileScheduler::complete()
+	{
+		m_completed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	std::vector<std::shared_ptr<scene_slab>>
+	TileScheduler::queued(std::size_t worker)
+	{
+		WorkerQueue& queue = *m_queues[worker % m_queues.size()];
+		const std::lock_guard<std::mutex> lock(queue.mutex);
+		return {queue.slabs.begin(), queue.slabs.end()};
+	}
+
+	std::size_t TileScheduler::total() const
+	{
+		return m_total.load(std::memory_order_relaxed);
+	}
+
+	std::size_t TileScheduler::completed() const
+	{
+		return m_completed.load(std::memory_order_relaxed);
+	}
+
+	std::shared_ptr<scene_slab> TileScheduler::pop_front(std::size_t worker)
+	{
+		WorkerQueue& queue = *m_queues[worker];
+		const std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.slabs.empty()) {
+			return nullptr;
+		}
+		std::shared_ptr<scene_slab> slab = std::move(queue.slabs.front());
+		queue.slabs.pop_front();
+		return slab;
+	}
+
+	std::shared_ptr<scene_slab> TileScheduler::steal(std::size_t victim)
+	{
+		WorkerQueue& queue = *m_queues[victim];
+		const std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.slabs.empty()) {
+			return nullptr;
+		}
+		// The back is furthest along the curve from where the owner works
+		std::shared_ptr<scene_slab> slab = std::move(queue.slabs.back());
+		queue.slabs.pop_back();
+		return slab;
+	}
+
+	/**
+	Splits a slab into quarters while the queues are draining. The first
+	quarter is returned and the others go to the front of the worker's own
+	queue, where idle threads can steal them
+
+	@param worker the index of the worker that took the slab
+	@param slab the slab that was taken
+
+	@returns the slab the worker should render now
+	*/
+	std::shared_ptr<scene_slab>
+	TileScheduler::split(std::size_t worker, std::shared_ptr<scene_slab> slab)
+	{
+		int width  = slab->end_x - slab->start_x;
+		int height = slab->end_y - slab->start_y;
+		if (m_remaining.load(std::memory_order_relaxed) > m_queues.size() ||
+			(width < 2 * m_min_slab_size && height < 2 * m_min_slab_size)) {
+			return slab;
+		}
+
+		// Only halve the sides that stay above the minimum
+		int mid_x = width >= 2 * m_min_slab_size ? slab->start_x + width / 2
+												 : slab->end_x;
+		int mid_y = height >= 2 * m_min_slab_size ? slab->start_y + height / 2
+												  : slab->end_y;
+
+		std::vector<std::shared_ptr<scene_slab>> parts;
+		for (auto [y0, y1] : {std::pair{slab->start_y, mid_y},
+							  std::pair{mid_y, slab->end_y}}) {
+			for (auto [x0, x1] : {std::pair{slab->start_x, mid_x},
+								  std::pair{mid_x, slab->end_x}}) {
+				if (x0 < x1 && y0 < y1) {
+					parts.push_back(
+						std::make_shared<scene_slab>(slab->world,
+													 slab->framebuffer,
+													 x0,
+													 x1,
+													 y0,
+													 y1));
+					parts.back()->sample_counts = slab->sample_counts;
+
+					// Hybrid renders: the part keeps the primitives that
+					// may be seen in it
+					for (BinnedPrimitive const& binned : slab->primitives) {
+						if (binned.start_x < x1 && x0 < binned.end_x &&
+							binned.start_y < y1 && y0 < binned.end_y) {
+							parts.back()->primitives.push_back(binned);
+						}
+					}
+				}
+			}
+		}
+
+		m_total.fetch_add(parts.size() - 1, std::memory_order_relaxed);
+		{
+			WorkerQueue& queue = *m_queues[worker];
+			const std::lock_guard<std::mutex> lock(queue.mutex);
+			for (std::size_t i{parts.size() - 1}; i > 0; --i) {
+				queue.slabs.push_front(parts[i]);
+			}
+			m_remaining.fetch_add(parts.size() - 1, std::memory_order_release);
+		}
+		return parts.front();
+	}
+
+	std::uint32_t morton_code(std::uint32_t x, std::uint32_t y)
+	{
+		auto spread = [](std::uint32_t v) {
+			v &= 0x0000ffff;
+			v = (v | (v << 8)) & 0x00ff00ff;
+			v = (v | (v << 4)) & 0x0f0f0f0f;
+			v = (v | (v << 2)) & 0x33333333;
+			v = (v | (v << 1)) & 0x55555555;
+			return v;
+		};
+		return spread(x) | (spread(y) << 1);
+	}
+} // namespace poly::structures
@@ -0,0 +1,15 @@
+#include "structures/visibility_buffer.hpp"
+#include <limits>
+
+namespace poly::structures
+{
+	void VisibilityBuffer::reset(std::size_t pixels,
+								 unsigned int samples_per_pixel)
+	{
+		samples = samples_per_pixel;
+		std::size_t entries = pixels * samples_per_pixel;
+		primitives.assign(entries, nullptr);
+		depths.assign(entries, std::numeric_limits<float>::max());
+		directions.resize(entries);
+	}
+} // namespace poly::structures
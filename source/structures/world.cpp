@@ -0,0 +1,88 @@
+#include "structures/world.hpp"
+#include "structures/KDTree.hpp"
+#include "structures/surface_interaction.hpp"
+#include "structures/light_tree.hpp"
+#include "structures/view_plane.hpp"
+#include "utilities/random.hpp"
+
+namespace poly::structures
+{
+	/**
+	Intersects the ray with a list of objects. The objects only record the
+	distance to the closest hit, its normal, uvs and material are resolved
+	once at the end
+
+	@param objects the objects to test, shared or plain pointers
+	@param ray the ray to trace
+	@param sr the interaction, only updated for hits closer than sr.m_tmin
+
+	@returns true if any object was hit
+	*/
+	template<typename Objects>
+	static bool closest_hit_of(Objects const& objects,
+							   atlas::math::Ray<atlas::math::Vector> const& ray,
+							   SurfaceInteraction& sr)
+	{
+		float previous_tmin = sr.m_tmin;
+		bool hit{false};
+		for (auto const& obj : objects) {
+			if (obj->hit(ray, sr)) {
+				hit = true;
+			}
+		}
+
+		if (sr.m_tmin < previous_tmin && sr.m_object) {
+			sr.m_ray = ray;
+			sr.m_object->interaction_resolve(sr);
+		}
+		return hit;
+	}
+
+	bool World::closest_hit(atlas::math::Ray<atlas::math::Vector> const& ray,
+							SurfaceInteraction& sr) const
+	{
+		return closest_hit_of(m_scene, ray, sr);
+	}
+
+	bool World::closest_hit(
+		atlas::math::Ray<atlas::math::Vector> const& ray,
+		SurfaceInteraction& sr,
+		std::vector<poly::object::Object const*> const& objects) const
+	{
+		return closest_hit_of(objects, ray, sr);
+	}
+
+	bool World::light_sampling() const
+	{
+		// Small light counts keep shading from every light, which is exact
+		return m_light_tree && m_vp->light_samples > 0 &&
+			   m_light_tree->size() > m_vp->light_samples;
+	}
+
+	/**
+	Picks the lights to shade a hit from. Without light sampling that is every
+	light at full weight. Otherwise the picks come from the light tree, drawn
+	from a generator keyed by the hit so that any tracer or thread shading it
+	picks the same lights
+
+	@param sr the hit to shade
+	@param lights cleared, then filled with the lights and their weights
+	*/
+	void World::select_lights(SurfaceInteraction const& sr,
+							  std::vector<LightSample>& lights) const
+	{
+		if (!light_sampling()) {
+			lights.clear();
+			for (std::uint32_t l{0}; l < m_lights.size(); ++l) {
+				lights.push_back({l, 1.0f});
+			}
+			return;
+		}
+
+		atlas::math::Point point = sr.get_hitpoint();
+		poly::utils::Random rng(
+			poly::utils::RandomDomain::light,
+			{poly::utils::float_key({point.x, point.y, point.z}), sr.depth});
+		m_light_tree->sample(point, m_vp->light_samples, rng, lights);
+	}
+} // namespace poly::structures
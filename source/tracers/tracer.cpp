@@ -3,7 +3,7 @@
 namespace poly::structures {
 	Tracer::Tracer(poly::structures::World& _world): m_world{_world} {}
 	
-	Colour Tracer::trace_ray([[maybe_unused]]math::Ray<math::Vector> const& ray, [[maybe_unused]] World const& world, [[maybe_unused]] const unsigned int depth) const
+	Colour Tracer::trace_ray([[maybe_unused]]math::Ray<math::Vector> const& ray, [[maybe_unused]] World const& world, [[maybe_unused]] const unsigned int depth, [[maybe_unused]] Colour const& throughput) const
 	{
 		return Colour(0.0f, 0.0f, 0.0f);
 	}
@@ -0,0 +1,323 @@
+#include "tracers/wavefront_tracer.hpp"
+#include "tracers/whitted_tracer.hpp"
+#include "lights/light.hpp"
+#include "structures/light_tree.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace poly::structures {
+	// Origins are quantised to this many bits per axis within the wave
+	static constexpr unsigned int cell_bits = 10;
+
+	// Shadow rays queued before they are traced
+	static constexpr std::size_t max_shadow_rays = 1 << 15;
+
+	/**
+	Spreads the low 10 bits of a value out to every third bit
+
+	@param value the value to spread
+
+	@returns the spread bits, ready to be interleaved
+	*/
+	static std::uint64_t spread_bits(std::uint64_t value)
+	{
+		value &= 0x3ff;
+		value = (value | (value << 16)) & 0x30000ff;
+		value = (value | (value << 8)) & 0x300f00f;
+		value = (value | (value << 4)) & 0x30c30c3;
+		value = (value | (value << 2)) & 0x9249249;
+		return value;
+	}
+
+	/**
+	@param points the points to bound
+
+	@returns the lower corner and extent of the points' bounding box
+	*/
+	static std::pair<math::Vector, math::Vector> point_bounds(std::vector<math::Vector> const& points)
+	{
+		math::Vector lower = points.front();
+		math::Vector upper = points.front();
+		for (math::Vector const& point : points) {
+			lower = glm::min(lower, point);
+			upper = glm::max(upper, point);
+		}
+		return {lower, upper - lower};
+	}
+
+	/**
+	Finds the Morton code of the cell holding a point, the cells splitting
+	the box into 2^cell_bits slices per axis
+
+	@param point the point to locate
+	@param lower the lower corner of the box
+	@param extent the size of the box
+
+	@returns the cell's Morton code, 3 * cell_bits wide
+	*/
+	static std::uint64_t morton_cell(math::Vector const& point, math::Vector const& lower, math::Vector const& extent)
+	{
+		float cells = (float)((1u << cell_bits) - 1);
+		std::uint64_t cell[3];
+		for (int axis{0}; axis < 3; ++axis) {
+			float offset = point[axis] - lower[axis];
+			cell[axis] = extent[axis] > 0.0f
+							 ? (std::uint64_t)(offset / extent[axis] * cells)
+							 : 0u;
+		}
+		return spread_bits(cell[0]) | (spread_bits(cell[1]) << 1) |
+			   (spread_bits(cell[2]) << 2);
+	}
+
+	void RayQueue::push(math::Ray<math::Vector> const& ray, Colour const& throughput, std::uint32_t pixel)
+	{
+		origins.push_back(ray.o);
+		directions.push_back(ray.d);
+		throughputs.push_back(throughput);
+		pixels.push_back(pixel);
+	}
+
+	void RayQueue::clear()
+	{
+		origins.clear();
+		directions.clear();
+		throughputs.clear();
+		pixels.clear();
+	}
+
+	void ShadowQueue::push(math::Ray<math::Vector> const& ray, std::uint32_t light, Colour const& contribution, std::uint32_t pixel)
+	{
+		origins.push_back(ray.o);
+		directions.push_back(ray.d);
+		lights.push_back(light);
+		contributions.push_back(contribution);
+		pixels.push_back(pixel);
+	}
+
+	void ShadowQueue::clear()
+	{
+		origins.clear();
+		directions.clear();
+		lights.clear();
+		contributions.clear();
+		pixels.clear();
+	}
+
+	WavefrontTracer::WavefrontTracer(World const& world, bool sort_secondary) :
+		m_world{world},
+		m_sort_secondary{sort_secondary}
+	{ }
+
+	/**
+	Runs waves until no rays are left. Each wave is intersected, shaded and
+	has its shadow rays traced before the next wave starts
+
+	@param rays the first wave, e.g. camera rays, left empty
+	@param radiance the buffer the pixels of the rays index into
+	@param camera_objects the objects the first wave may hit, all if null
+	*/
+	void WavefrontTracer::trace(RayQueue& rays, std::vector<Colour>& radiance, std::vector<poly::object::Object const*> const* camera_objects)
+	{
+		std::vector<poly::object::Object const*> const* objects = camera_objects;
+		while (rays.size() > 0) {
+			// Camera rays are already coherent
+			if (m_sort_secondary && rays.depth > 0) {
+				sort_rays(rays);
+			}
+			intersect(rays, radiance, objects);
+			objects = nullptr;
+
+			m_next.clear();
+			m_next.depth = rays.depth + 1;
+			shade(radiance);
+			trace_shadows(radiance);
+
+			std::swap(rays, m_next);
+		}
+	}
+
+	/**
+	Reorders a wave of secondary rays so that rays heading the same way from
+	nearby points are traced together. The key is the direction octant
+	followed by the Morton code of the origin's cell in the wave's bounds
+
+	@param rays the wave to sort
+	*/
+	void WavefrontTracer::sort_rays(RayQueue& rays)
+	{
+		auto [lower, extent] = point_bounds(rays.origins);
+
+		m_keys.clear();
+		for (std::size_t i{0}; i < rays.size(); ++i) {
+			math::Vector const& d = rays.directions[i];
+			std::uint64_t octant = (d.x < 0.0f ? 1u : 0u) |
+								   (d.y < 0.0f ? 2u : 0u) |
+								   (d.z < 0.0f ? 4u : 0u);
+			std::uint64_t morton = morton_cell(rays.origins[i], lower, extent);
+
+			m_keys.emplace_back((octant << (3 * cell_bits)) | morton,
+								static_cast<std::uint32_t>(i));
+		}
+		std::sort(m_keys.begin(), m_keys.end());
+
+		m_sorted.clear();
+		m_sorted.depth = rays.depth;
+		for (auto const& key : m_keys) {
+			std::uint32_t i = key.second;
+			m_sorted.push(math::Ray<math::Vector>(rays.origins[i], rays.directions[i]),
+						  rays.throughputs[i],
+						  rays.pixels[i]);
+		}
+		std::swap(rays, m_sorted);
+	}
+
+	/**
+	Finds the closest hit of every ray in the wave. Rays that are pruned are
+	dropped and rays that miss pick up the background straight away
+
+	@param rays the wave to intersect
+	@param radiance the buffer the pixels of the rays index into
+	@param objects the objects the wave may hit, all if null
+	*/
+	void WavefrontTracer::intersect(RayQueue const& rays, std::vector<Colour>& radiance, std::vector<poly::object::Object const*> const* objects)
+	{
+		m_hits.clear();
+		m_hit_pixels.clear();
+
+		for (std::size_t i{0}; i < rays.size(); ++i) {
+			math::Ray<math::Vector> ray(rays.origins[i], rays.directions[i]);
+
+			// Camera rays are always traced, as in the Whitted tracer
+			float survival = 1.0f;
+			if (rays.depth > 0) {
+				survival = path_survival(ray, m_world, rays.depth, rays.throughputs[i]);
+				if (survival == 0.0f) {
+					continue;
+				}
+			}
+			Colour throughput = rays.throughputs[i] / survival;
+
+			SurfaceInteraction sr;
+			sr.m_colour = m_world.m_background;
+			bool did_hit = objects ? m_world.closest_hit(ray, sr, *objects)
+								   : m_world.closest_hit(ray, sr);
+
+			if (did_hit && sr.m_material != nullptr) {
+				sr.depth = rays.depth;
+				sr.m_ray = ray;
+				sr.m_throughput = throughput;
+				m_hits.push_back(sr);
+				m_hit_pixels.push_back(rays.pixels[i]);
+			}
+			else {
+				radiance[rays.pixels[i]] += throughput * m_world.m_background;
+			}
+		}
+	}
+
+	/**
+	Shades the hits of a wave one material at a time, from the lights the
+	world selects for each hit. Lights that need a shadow ray queue it with
+	the light it would let through, and the scattered rays are queued as the
+	next wave
+
+	@param radiance the buffer the pixels of the hits index into
+	*/
+	void WavefrontTracer::shade(std::vector<Colour>& radiance)
+	{
+		m_order.resize(m_hits.size());
+		std::iota(m_order.begin(), m_order.end(), 0u);
+		std::stable_sort(m_order.begin(), m_order.end(), [this](std::uint32_t a, std::uint32_t b) {
+			return std::less<poly::material::Material const*>()(m_hits[a].m_material, m_hits[b].m_material);
+		});
+
+		for (std::uint32_t hit : m_order) {
+			SurfaceInteraction& sr = m_hits[hit];
+			std::uint32_t pixel = m_hit_pixels[hit];
+			poly::material::Material const& material = *sr.m_material;
+
+			radiance[pixel] += sr.m_throughput * material.shade_ambient(sr, m_world);
+
+			m_world.select_lights(sr, m_light_samples);
+			for (LightSample const& sample : m_light_samples) {
+				auto const& light = m_world.m_lights[sample.light];
+				math::Vector w_i = light->get_direction(sr);
+				Colour contribution = material.shade_light(sr, w_i, sample.weight * light->unoccluded_L(sr, m_world));
+				if (contribution == Colour(0.0f, 0.0f, 0.0f)) {
+					continue;
+				}
+				contribution *= sr.m_throughput;
+
+				math::Ray<math::Vector> shadow_ray;
+				if (light->shadow_ray(sr, shadow_ray)) {
+					m_shadows.push(shadow_ray, sample.light, contribution, pixel);
+				}
+				else {
+					radiance[pixel] += contribution;
+				}
+			}
+
+			// With many lights the queue would outgrow the cache, trace
+			// what is there before carrying on
+			if (m_shadows.size() >= max_shadow_rays) {
+				trace_shadows(radiance);
+			}
+
+			m_scattered.clear();
+			material.scatter(sr, m_scattered);
+			for (poly::material::ScatteredRay const& scattered : m_scattered) {
+				m_next.push(scattered.ray, sr.m_throughput * scattered.weight, pixel);
+			}
+		}
+	}
+
+	/**
+	Traces the queued shadow rays as one batch per light, so that lights can
+	trace them as packets. The rays are bucketed by light without otherwise
+	changing their order, which follows the shading order and so keeps nearby
+	points together
+
+	@param radiance the buffer the pixels of the shadow rays index into
+	*/
+	void WavefrontTracer::trace_shadows(std::vector<Colour>& radiance)
+	{
+		// Counting sort on the light index
+		m_light_starts.assign(m_world.m_lights.size() + 1, 0);
+		for (std::uint32_t light : m_shadows.lights) {
+			++m_light_starts[light + 1];
+		}
+		for (std::size_t l{1}; l < m_light_starts.size(); ++l) {
+			m_light_starts[l] += m_light_starts[l - 1];
+		}
+		m_shadow_order.resize(m_shadows.size());
+		m_light_ends.assign(m_light_starts.begin(), m_light_starts.end() - 1);
+		for (std::uint32_t shadow{0}; shadow < m_shadows.size(); ++shadow) {
+			m_shadow_order[m_light_ends[m_shadows.lights[shadow]]++] = shadow;
+		}
+
+		for (std::size_t light{0}; light < m_world.m_lights.size(); ++light) {
+			std::uint32_t first = m_light_starts[light];
+			std::uint32_t last = m_light_starts[light + 1];
+			if (first == last) {
+				continue;
+			}
+
+			m_batch.clear();
+			for (std::uint32_t k{first}; k < last; ++k) {
+				std::uint32_t shadow = m_shadow_order[k];
+				m_batch.emplace_back(m_shadows.origins[shadow], m_shadows.directions[shadow]);
+			}
+
+			m_world.m_lights[light]->occluded(m_batch, m_world, m_blocked);
+
+			// Fold the results back into the pixels
+			for (std::uint32_t k{first}; k < last; ++k) {
+				std::uint32_t shadow = m_shadow_order[k];
+				if (!m_blocked[k - first]) {
+					radiance[m_shadows.pixels[shadow]] += m_shadows.contributions[shadow];
+				}
+			}
+		}
+		m_shadows.clear();
+	}
+}
@@ -1,34 +1,65 @@
 #include "tracers/whitted_tracer.hpp"
+#include "utilities/random.hpp"
+#include <algorithm>
 
 using namespace atlas;
 
 namespace poly::structures {
-	WhittedTracer::WhittedTracer(poly::structures::World& world_) : Tracer(world_) { }
+	// Paths that survive the roulette are never weighted up by more than this
+	static constexpr float min_survival = 0.05f;
 
-	Colour WhittedTracer::trace_ray(math::Ray<math::Vector> const& ray, World const& world, const unsigned int depth) const
+	float path_survival(math::Ray<math::Vector> const& ray, World const& world, const unsigned int depth, Colour const& throughput)
 	{
 		if (depth > world.m_vp->max_depth) {
-			return Colour(0.0f, 0.0f, 0.0f);
+			return 0.0f;
 		}
-		else {
-			SurfaceInteraction temp_sr;
-			bool did_hit = false;
-			for (std::shared_ptr<poly::object::Object> obj : world.m_scene) {
-				if (obj->hit(ray, temp_sr)) {
-					did_hit = true;
-				}
-			}
 
-			// If this ray hit an object, return material's shading
-			if (did_hit && temp_sr.m_material != nullptr) {
-				temp_sr.depth = depth;
-				temp_sr.m_ray = ray;
-				Colour returned_colour = temp_sr.m_material->shade(temp_sr, world);
-				return returned_colour;
-			}
-			else {
-				return world.m_background;
+		// Branches that could barely change the pixel are not traced at all
+		float contribution = std::max({throughput.x, throughput.y, throughput.z});
+		if (contribution < world.m_vp->min_contribution) {
+			return 0.0f;
+		}
+
+		// Deep, weak paths are ended at random and the survivors weighted up,
+		// which keeps the average unbiased
+		if (world.m_vp->roulette_depth > 0 && depth >= world.m_vp->roulette_depth) {
+			float survival = std::clamp(contribution, min_survival, 1.0f);
+			// Keyed by the ray, so the draw does not depend on which thread
+			// traces the branch
+			std::uint64_t key = poly::utils::float_key(
+				{ray.o.x, ray.o.y, ray.o.z, ray.d.x, ray.d.y, ray.d.z});
+			poly::utils::Random rng(poly::utils::RandomDomain::roulette,
+									{key, depth});
+			if (rng.uniform() >= survival) {
+				return 0.0f;
 			}
+			return survival;
+		}
+		return 1.0f;
+	}
+
+	WhittedTracer::WhittedTracer(poly::structures::World& world_) : Tracer(world_) { }
+
+	Colour WhittedTracer::trace_ray(math::Ray<math::Vector> const& ray, World const& world, const unsigned int depth, Colour const& throughput) const
+	{
+		float survival = path_survival(ray, world, depth, throughput);
+		if (survival == 0.0f) {
+			return Colour(0.0f, 0.0f, 0.0f);
+		}
+
+		SurfaceInteraction temp_sr;
+		bool did_hit = world.closest_hit(ray, temp_sr);
+
+		// If this ray hit an object, return material's shading
+		if (did_hit && temp_sr.m_material != nullptr) {
+			temp_sr.depth = depth;
+			temp_sr.m_ray = ray;
+			temp_sr.m_throughput = throughput / survival;
+			Colour returned_colour = temp_sr.m_material->shade(temp_sr, world);
+			return returned_colour / survival;
+		}
+		else {
+			return world.m_background / survival;
 		}
 	}
 }
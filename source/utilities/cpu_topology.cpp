@@ -0,0 +1,261 @@
+#include "utilities/cpu_topology.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace poly::utils
+{
+	/**
+	Reads the first line of a small kernel file
+
+	@param path the file to read
+
+	@returns the line, empty if the file does not exist
+	*/
+	static std::string read_line(std::string const& path)
+	{
+		std::ifstream file(path);
+		std::string line;
+		std::getline(file, line);
+		return line;
+	}
+
+	std::vector<int> parse_cpu_list(std::string const& list)
+	{
+		std::vector<int> cpus;
+		std::stringstream ranges(list);
+		std::string range;
+		while (std::getline(ranges, range, ',')) {
+			if (range.empty()) {
+				continue;
+			}
+			std::size_t dash = range.find('-');
+			try {
+				int first = std::stoi(range.substr(0, dash));
+				int last  = dash == std::string::npos
+								? first
+								: std::stoi(range.substr(dash + 1));
+				for (int cpu{first}; cpu <= last; ++cpu) {
+					cpus.push_back(cpu);
+				}
+			}
+			catch (std::logic_error const&) {
+				// Not a CPU list, ignore the entry
+			}
+		}
+		return cpus;
+	}
+
+	/**
+	Finds the cgroup path of this process for a controller
+
+	@param controller the v1 controller name, or empty for the v2 hierarchy
+
+	@returns the path inside the hierarchy, empty if not found
+	*/
+	static std::string cgroup_path(std::string const& controller)
+	{
+		std::ifstream file("/proc/self/cgroup");
+		std::string line;
+		while (std::getline(file, line)) {
+			// Lines are "id:controllers:path"
+			std::size_t first  = line.find(':');
+			std::size_t second = line.find(':', first + 1);
+			if (first == std::string::npos || second == std::string::npos) {
+				continue;
+			}
+			std::string controllers = line.substr(first + 1, second - first - 1);
+			std::string path		= line.substr(second + 1);
+
+			if (controller.empty()) {
+				if (controllers.empty()) {
+					return path;
+				}
+				continue;
+			}
+			std::stringstream names(controllers);
+			std::string name;
+			while (std::getline(names, name, ',')) {
+				if (name == controller) {
+					return path;
+				}
+			}
+		}
+		return {};
+	}
+
+	/**
+	Converts a quota and period pair into whole cores
+
+	@param quota the CPU time allowed per period, negative if unlimited
+	@param period the length of the period, in the same unit
+
+	@returns the cores, rounded up, or 0 if the quota is unlimited
+	*/
+	std::size_t quota_to_cores(double quota, double period)
+	{
+		if (quota <= 0.0 || period <= 0.0) {
+			return 0;
+		}
+		return static_cast<std::size_t>(std::ceil(quota / period));
+	}
+
+	/**
+	Reads the CPU quota of this process from cgroup v2 (cpu.max) or, failing
+	that, cgroup v1 (cpu.cfs_quota_us). For v2 every ancestor is checked since
+	the tightest limit up the tree applies
+
+	@returns the quota in whole cores, or 0 if there is no limit
+	*/
+	static std::size_t cgroup_quota_cores()
+	{
+		std::size_t cores{0};
+		auto tighten = [&cores](std::size_t limit) {
+			if (limit > 0 && (cores == 0 || limit < cores)) {
+				cores = limit;
+			}
+		};
+
+		// cgroup v2: "max 100000" or "<quota> <period>"
+		std::string path = cgroup_path("");
+		if (!path.empty() || !read_line("/sys/fs/cgroup/cpu.max").empty()) {
+			while (true) {
+				std::stringstream limits(
+					read_line("/sys/fs/cgroup" + path + "/cpu.max"));
+				std::string quota;
+				double period{0.0};
+				if (limits >> quota >> period && quota != "max") {
+					try {
+						tighten(quota_to_cores(std::stod(quota), period));
+					}
+					catch (std::logic_error const&) {
+					}
+				}
+
+				if (path.empty() || path == "/") {
+					break;
+				}
+				path = path.substr(0, path.find_last_of('/'));
+			}
+		}
+
+		// cgroup v1, the controller may be mounted on its own or with cpuacct
+		std::string v1_path = cgroup_path("cpu");
+		for (std::string mount : {"/sys/fs/cgroup/cpu",
+								  "/sys/fs/cgroup/cpu,cpuacct"}) {
+			for (std::string dir : {mount + v1_path, mount}) {
+				std::string quota = read_line(dir + "/cpu.cfs_quota_us");
+				std::string period = read_line(dir + "/cpu.cfs_period_us");
+				if (quota.empty() || period.empty()) {
+					continue;
+				}
+				try {
+					tighten(quota_to_cores(std::stod(quota), std::stod(period)));
+				}
+				catch (std::logic_error const&) {
+				}
+			}
+		}
+
+		return cores;
+	}
+
+	/**
+	@returns the CPUs in this process's affinity mask, or every CPU reported
+	by the standard library where the mask cannot be read
+	*/
+	static std::vector<int> affinity_cpus()
+	{
+		std::vector<int> cpus;
+#ifdef __linux__
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+			for (int cpu{0}; cpu < CPU_SETSIZE; ++cpu) {
+				if (CPU_ISSET(cpu, &mask)) {
+					cpus.push_back(cpu);
+				}
+			}
+		}
+#endif
+		if (cpus.empty()) {
+			unsigned int count = std::max(std::thread::hardware_concurrency(), 1u);
+			for (unsigned int cpu{0}; cpu < count; ++cpu) {
+				cpus.push_back(static_cast<int>(cpu));
+			}
+		}
+		return cpus;
+	}
+
+	/**
+	Detects the topology on first use. Usable CPUs are grouped by the NUMA node
+	that owns them (from /sys/devices/system/node), so that consecutive worker
+	threads pinned in order share a node
+
+	@returns the topology of the machine as seen by this process
+	*/
+	CpuTopology const& cpu_topology()
+	{
+		static const CpuTopology topology = []() {
+			CpuTopology detected;
+			detected.quota_cores = cgroup_quota_cores();
+
+			std::vector<int> usable = affinity_cpus();
+			std::vector<std::size_t> node_of(
+				static_cast<std::size_t>(usable.back()) + 1, 0);
+
+			std::vector<int> online =
+				parse_cpu_list(read_line("/sys/devices/system/node/online"));
+			for (std::size_t n{0}; n < online.size(); ++n) {
+				for (int cpu : parse_cpu_list(
+						 read_line("/sys/devices/system/node/node" +
+								   std::to_string(online[n]) + "/cpulist"))) {
+					if (cpu >= 0 && static_cast<std::size_t>(cpu) < node_of.size()) {
+						node_of[static_cast<std::size_t>(cpu)] = n;
+					}
+				}
+			}
+
+			std::stable_sort(usable.begin(), usable.end(), [&](int a, int b) {
+				return node_of[static_cast<std::size_t>(a)] <
+					   node_of[static_cast<std::size_t>(b)];
+			});
+			for (int cpu : usable) {
+				detected.cpus.push_back(cpu);
+				detected.nodes.push_back(node_of[static_cast<std::size_t>(cpu)]);
+			}
+			return detected;
+		}();
+		return topology;
+	}
+
+	std::size_t available_cores()
+	{
+		CpuTopology const& topology = cpu_topology();
+		std::size_t cores			= topology.cpus.size();
+		if (topology.quota_cores > 0) {
+			cores = std::min(cores, topology.quota_cores);
+		}
+		return std::max<std::size_t>(cores, 1);
+	}
+
+	bool pin_current_thread(int cpu)
+	{
+#ifdef __linux__
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		CPU_SET(cpu, &mask);
+		return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+		(void)cpu;
+		return false;
+#endif
+	}
+} // namespace poly::utils
@@ -1,6 +1,8 @@
 #include <thread>
 #include <iostream>
 #include "utilities/parser.hpp"
+#include "utilities/cpu_topology.hpp"
+#include "utilities/thread_pool.hpp"
 
 #include "objects/sphere.hpp"
 #include "objects/torus.hpp"
@@ -14,6 +16,11 @@
 #include "lights/ambient_occlusion.hpp"
 
 #include "structures/KDTree.hpp"
+#include "structures/light_tree.hpp"
+
+#include "samplers/blue_noise.hpp"
+#include "samplers/halton.hpp"
+#include "samplers/sobol.hpp"
 
 #include "integrators/SPPMIntegrator.hpp"
 
@@ -124,6 +131,18 @@ properties
 					task["camera"]["sampler"]["samples"],
 					task["camera"]["sampler"]["sets"]);
 			}
+			else if (cam_type == "sobol") {
+				w.m_sampler = std::make_shared<poly::sampler::AA_Sobol>(
+					task["camera"]["sampler"]["samples"]);
+			}
+			else if (cam_type == "halton") {
+				w.m_sampler = std::make_shared<poly::sampler::AA_Halton>(
+					task["camera"]["sampler"]["samples"]);
+			}
+			else if (cam_type == "blue_noise") {
+				w.m_sampler = std::make_shared<poly::sampler::AA_BlueNoise>(
+					task["camera"]["sampler"]["samples"]);
+			}
 			else {
 				throw std::runtime_error("Incorrect sampler parameters");
 			}
@@ -139,28 +158,51 @@ properties
 	 */
 	void parse_objects(poly::structures::World& w, nlohmann::json& task)
 	{
+		// Meshes are loaded and their trees built on the pool, each keeps
+		// its slot in the scene so the object order matches the taskfile
+		std::vector<std::pair<std::size_t,
+							  std::future<std::shared_ptr<poly::object::Object>>>>
+			pending_meshes;
+
 		for (auto obj : task["objects"]) {
 			if (obj["type"] == "mesh") {
 				std::string path_to_object(obj["object_file"]);
 				std::string path_to_material(obj["material_file"]);
-
-				std::vector<std::shared_ptr<poly::object::Object>> object_list;
-
-				std::shared_ptr<poly::object::Mesh> s =
-					std::make_shared<poly::object::Mesh>(
-						path_to_object.c_str(),
-						path_to_material.c_str(),
-						parse_vector(obj["position"]));
-
+				math::Vector position = parse_vector(obj["position"]);
+				math::Vector scale	  = parse_vector(obj["scale"]);
 				std::shared_ptr<poly::material::Material> material =
 					parse_material(obj["material"]);
-				s->material_set(material);
-				s->scale(parse_vector(obj["scale"]));
-				// s->translate(parse_vector(obj["position"]));
-				s->dump_to_list(object_list);
 
-				w.m_scene.push_back(std::make_shared<poly::structures::KDTree>(
-					object_list, 80, 30, 0.75f, 15, -1));
+				pending_meshes.emplace_back(
+					w.m_scene.size(),
+					ThreadPool::instance().submit(
+						[path_to_object,
+						 path_to_material,
+						 position,
+						 scale,
+						 material]() -> std::shared_ptr<poly::object::Object> {
+							std::vector<std::shared_ptr<poly::object::Object>>
+								object_list;
+
+							std::shared_ptr<poly::object::Mesh> s =
+								std::make_shared<poly::object::Mesh>(
+									path_to_object.c_str(),
+									path_to_material.c_str(),
+									position);
+							s->material_set(material);
+							s->scale(scale);
+							// s->translate(position);
+							s->dump_to_list(object_list);
+
+							// The tree carries the mesh material so that the
+							// photon mapper can tell specular meshes apart
+							std::shared_ptr<poly::structures::KDTree> tree =
+								std::make_shared<poly::structures::KDTree>(
+									object_list, 80, 30, 0.75f, 15, -1);
+							tree->material_set(material);
+							return tree;
+						}));
+				w.m_scene.push_back(nullptr);
 			}
 			else if (obj["type"] == "sphere") {
 				std::shared_ptr<poly::object::Sphere> s =
@@ -215,6 +257,10 @@ properties
 				throw std::runtime_error("ERROR: object type %s not supported");
 			}
 		}
+
+		for (auto& [slot, mesh] : pending_meshes) {
+			w.m_scene[slot] = mesh.get();
+		}
 	}
 
 	/*
@@ -240,6 +286,14 @@ properties
 				throw std::runtime_error("Incorrect light parameters");
 			}
 		}
+
+		w.m_light_tree =
+			std::make_shared<poly::structures::LightTree>(w.m_lights);
+		if (w.light_sampling()) {
+			std::clog << "INFO: sampling " << w.m_vp->light_samples << " of "
+					  << w.m_light_tree->size()
+					  << " lights per shading point" << std::endl;
+		}
 	}
 
 	/**
@@ -259,6 +313,19 @@ properties
 			vp->vres	  = task["image_height"];
 			vp->hres	  = task["image_width"];
 			vp->max_depth = task["max_depth"];
+
+			// Optional pruning of reflection and refraction branches
+			if (task.contains("min_contribution")) {
+				vp->min_contribution = task["min_contribution"];
+			}
+			if (task.contains("russian_roulette_depth")) {
+				vp->roulette_depth = task["russian_roulette_depth"];
+			}
+
+			// Optional light tree sampling for scenes with many lights
+			if (task.contains("light_samples")) {
+				vp->light_samples = task["light_samples"];
+			}
 		}
 		catch (const nlohmann::detail::type_error& e) {
 			std::wcerr << "ERROR: incorrect viewplane parameters" << std::endl;
@@ -306,6 +373,84 @@ properties
 		}
 	}
 
+	/**
+	Decides how many threads the render may use, from the taskfile's
+	max_threads and the cores this process can use. The affinity mask and the
+	cgroup CPU quota are respected, so a container limited to a few CPUs on a
+	large host is not oversubscribed
+
+	@param json the JSON taskfile
+
+	@throws nlohmann::detail::type_error if max_threads is missing or not a
+	number
+
+	@returns the number of worker threads, at least 1
+	*/
+	std::size_t thread_count(nlohmann::json& json)
+	{
+		// Autodetect possible threads
+		std::size_t maximum_threads_allowed = json["max_threads"];
+
+		CpuTopology const& topology = cpu_topology();
+		const auto processor_count	= available_cores();
+		std::clog << "INFO: detecting " << processor_count << " cores ("
+				  << topology.cpus.size() << " in affinity mask";
+		if (topology.quota_cores > 0) {
+			std::clog << ", cgroup quota of " << topology.quota_cores;
+		}
+		std::clog << ")" << std::endl;
+
+		if (processor_count < maximum_threads_allowed && processor_count > 0) {
+			std::clog << "INFO: using " << processor_count << " cores"
+					  << std::endl;
+			return processor_count;
+		}
+		else if (maximum_threads_allowed > 0) {
+			std::clog << "INFO: using max of " << maximum_threads_allowed
+					  << " cores" << std::endl;
+			return maximum_threads_allowed;
+		}
+		else {
+			std::clog << "INFO: using default of 1 core" << std::endl;
+			return 1;
+		}
+	}
+
+	/**
+	Reads whether worker threads should be pinned to their own cores
+
+	@param json the JSON taskfile
+
+	@returns the value of the optional pin_threads key, false by default
+	*/
+	bool pin_threads(nlohmann::json& json)
+	{
+		if (json.contains("pin_threads")) {
+			return json["pin_threads"].get<bool>();
+		}
+		return false;
+	}
+
+	/**
+	Reads the seed of the random streams. Without one the time is used, so
+	every run differs
+
+	@param json the JSON taskfile
+
+	@throws nlohmann::detail::type_error if the seed is not a number
+
+	@returns the value of the optional seed key
+	*/
+	std::uint64_t parse_seed(nlohmann::json& json)
+	{
+		std::uint64_t seed = static_cast<std::uint64_t>(time(0));
+		if (json.contains("seed")) {
+			seed = json["seed"].get<std::uint64_t>();
+		}
+		std::clog << "INFO: random seed " << seed << std::endl;
+		return seed;
+	}
+
 	/**
 	Creates a camera given JSON parameters
 
@@ -323,26 +468,87 @@ properties
 		poly::camera::PinholeCamera cam =
 			poly::camera::PinholeCamera(camera_json["distance"]);
 
-		// Autodetect possible threads
-		std::size_t maximum_threads_allowed = json["max_threads"];
-
-		const auto processor_count = std::thread::hardware_concurrency();
-		std::clog << "INFO: detecting " << processor_count << " cores"
-				  << std::endl;
+		cam.set_max_threads(ThreadPool::instance().size());
 
-		if (processor_count < maximum_threads_allowed && processor_count > 0) {
-			std::clog << "INFO: using " << processor_count << " cores"
+		// Optional adaptive sampling, more samples only where pixels are noisy
+		if (camera_json.contains("sampler") &&
+			camera_json["sampler"].contains("adaptive")) {
+			nlohmann::json adaptive_json = camera_json["sampler"]["adaptive"];
+			poly::camera::AdaptiveSampling adaptive;
+			adaptive.max_samples = adaptive_json["max_samples"];
+			if (adaptive_json.contains("min_samples")) {
+				adaptive.min_samples = adaptive_json["min_samples"];
+			}
+			if (adaptive_json.contains("threshold")) {
+				adaptive.threshold = adaptive_json["threshold"];
+			}
+			if (adaptive_json.contains("sample_count_file")) {
+				adaptive.sample_count_file =
+					adaptive_json["sample_count_file"].get<std::string>();
+			}
+			std::clog << "INFO: adaptive sampling with " << adaptive.min_samples
+					  << " to " << adaptive.max_samples << " samples per pixel"
 					  << std::endl;
-			cam.set_max_threads(processor_count);
+			cam.adaptive_set(adaptive);
 		}
-		else if (maximum_threads_allowed > 0) {
-			std::clog << "INFO: using max of " << maximum_threads_allowed
-					  << " cores" << std::endl;
-			cam.set_max_threads(maximum_threads_allowed);
+
+		// Optional breadth-first tracing
+		if (camera_json.contains("wavefront")) {
+			bool sort_secondary = true;
+			if (camera_json.contains("sort_secondary_rays")) {
+				sort_secondary = camera_json["sort_secondary_rays"].get<bool>();
+			}
+			cam.wavefront_set(camera_json["wavefront"].get<bool>(),
+							  sort_secondary);
+			if (camera_json["wavefront"].get<bool>() &&
+				camera_json.contains("sampler") &&
+				camera_json["sampler"].contains("adaptive") &&
+				!camera_json.contains("progressive")) {
+				std::clog << "WARN: adaptive sampling is ignored by wavefront "
+							 "renders"
+						  << std::endl;
+			}
 		}
-		else {
-			std::clog << "INFO: using default of 1 core" << std::endl;
-			cam.set_max_threads(1);
+
+		// Optional rasterised first hits
+		if (camera_json.contains("hybrid")) {
+			bool hybrid = camera_json["hybrid"].get<bool>();
+			cam.hybrid_set(hybrid);
+			if (hybrid && camera_json.contains("wavefront") &&
+				camera_json["wavefront"].get<bool>()) {
+				std::clog << "WARN: hybrid rendering is ignored by wavefront "
+							 "renders"
+						  << std::endl;
+			}
+			else if (hybrid && camera_json.contains("sampler") &&
+					 camera_json["sampler"].contains("adaptive") &&
+					 !camera_json.contains("progressive")) {
+				std::clog << "WARN: hybrid rendering is ignored by adaptive "
+							 "renders"
+						  << std::endl;
+			}
+		}
+
+		// Optional progressive rendering, in passes until the time budget runs
+		// out or the process is asked to stop
+		if (camera_json.contains("progressive")) {
+			nlohmann::json progressive_json = camera_json["progressive"];
+			poly::camera::ProgressiveRendering progressive;
+			progressive.enabled = true;
+			if (progressive_json.contains("time_budget_seconds")) {
+				progressive.time_budget = progressive_json["time_budget_seconds"];
+			}
+			if (progressive_json.contains("samples_per_pass")) {
+				progressive.samples_per_pass =
+					progressive_json["samples_per_pass"];
+			}
+			if (camera_json.contains("sampler") &&
+				camera_json["sampler"].contains("adaptive")) {
+				std::clog << "WARN: adaptive sampling is ignored by progressive "
+							 "renders"
+						  << std::endl;
+			}
+			cam.progressive_set(progressive);
 		}
 
 		// Set the camera position and view parameters
@@ -385,6 +591,14 @@ properties
 		return expected_output;
 	}
 
+	/**
+	Creates a stochastic progressive photon mapper given JSON parameters
+
+	@param integrator the integrator to configure
+	@param json the JSON object holding the integrator's information
+
+	@returns true if the taskfile requests a photon mapping render
+	*/
 	bool create_SPPMIntegrator(poly::integrators::SPPMIntegrator& integrator,
 							   nlohmann::json& json)
 	{
@@ -396,6 +610,30 @@ properties
 				integrator_json["num_working_areas"],
 				integrator_json["direct_shading_strength"],
 				integrator_json["photon_strength_multiplier"]};
+
+			// Optional distribution of the iterations across processes
+			if (integrator_json.contains("worker_count")) {
+				integrator.set_worker(integrator_json["worker_index"],
+									  integrator_json["worker_count"]);
+			}
+			if (integrator_json.contains("accumulator_file")) {
+				integrator.set_accumulator_file(
+					integrator_json["accumulator_file"]);
+			}
+
+			// Optional stopping criteria
+			if (integrator_json.contains("target_error")) {
+				integrator.set_target_error(integrator_json["target_error"]);
+			}
+			if (integrator_json.contains("time_budget_seconds")) {
+				integrator.set_time_budget(
+					integrator_json["time_budget_seconds"]);
+			}
+
+			if (integrator_json.contains("caustic_photon_fraction")) {
+				integrator.set_caustic_photon_fraction(
+					integrator_json["caustic_photon_fraction"]);
+			}
 			return true;
 		}
 		catch ([[maybe_unused]] const nlohmann::detail::type_error& e) {
@@ -0,0 +1,98 @@
+#include "utilities/random.hpp"
+#include <cstring>
+
+namespace poly::utils
+{
+	static constexpr std::uint64_t pcg_multiplier = 6364136223846793005ull;
+
+	// Written once at startup, only read while rendering
+	static std::uint64_t global_seed = 0;
+
+	/**
+	Creates the generator for one key. The key selects both the stream
+	(increment) and the starting state, so neighbouring keys give unrelated
+	sequences
+
+	@param domain the subsystem the numbers are for
+	@param key the counters identifying the path, e.g. pixel and iteration
+	*/
+	Random::Random(RandomDomain domain, std::initializer_list<std::uint64_t> key)
+	{
+		std::uint64_t hash =
+			mix_bits(global_seed ^ static_cast<std::uint64_t>(domain));
+		for (std::uint64_t part : key) {
+			hash = mix_bits(hash ^ part);
+		}
+
+		// Increments must be odd
+		m_increment = (mix_bits(hash ^ 0x9e3779b97f4a7c15ull) << 1u) | 1u;
+		m_state		= 0;
+		next();
+		m_state += hash;
+		next();
+	}
+
+	std::uint32_t Random::next()
+	{
+		std::uint64_t old = m_state;
+		m_state			  = old * pcg_multiplier + m_increment;
+		auto xorshifted =
+			static_cast<std::uint32_t>(((old >> 18u) ^ old) >> 27u);
+		auto rotation = static_cast<std::uint32_t>(old >> 59u);
+		return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31u));
+	}
+
+	float Random::uniform()
+	{
+		// 24 random bits fill the float mantissa, so 1.0 is never returned
+		return static_cast<float>(next() >> 8u) * (1.0f / 16777216.0f);
+	}
+
+	/**
+	Draws an integer without modulo bias, by rejecting the values that would
+	wrap unevenly
+
+	@param bound the exclusive upper limit, must be positive
+
+	@returns a value in [0, bound)
+	*/
+	std::uint32_t Random::uniform(std::uint32_t bound)
+	{
+		std::uint32_t threshold = (-bound) % bound;
+		while (true) {
+			std::uint32_t value = next();
+			if (value >= threshold) {
+				return value % bound;
+			}
+		}
+	}
+
+	void set_random_seed(std::uint64_t seed)
+	{
+		global_seed = seed;
+	}
+
+	std::uint64_t random_seed()
+	{
+		return global_seed;
+	}
+
+	std::uint64_t mix_bits(std::uint64_t value)
+	{
+		value += 0x9e3779b97f4a7c15ull;
+		value = (value ^ (value >> 30u)) * 0xbf58476d1ce4e5b9ull;
+		value = (value ^ (value >> 27u)) * 0x94d049bb133111ebull;
+		return value ^ (value >> 31u);
+	}
+
+	std::uint64_t float_key(std::initializer_list<float> values)
+	{
+		std::uint64_t key{0};
+		for (float value : values) {
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			key = mix_bits(key ^ bits);
+		}
+		return key;
+	}
+} // namespace poly::utils
@@ -0,0 +1,38 @@
+#include "utilities/stop_signal.hpp"
+#include <atomic>
+#include <csignal>
+
+namespace poly::utils
+{
+	// Written from a signal handler, so it must never take a lock
+	static std::atomic<bool> stop_flag{false};
+	static_assert(std::atomic<bool>::is_always_lock_free,
+				  "the stop flag is set from a signal handler");
+
+	/**
+	Marks the render as stopping and restores the default action, so that
+	the next SIGTERM terminates the process
+
+	@param signal the signal received
+	*/
+	extern "C" void handle_stop_signal(int signal)
+	{
+		stop_flag.store(true, std::memory_order_relaxed);
+		std::signal(signal, SIG_DFL);
+	}
+
+	void install_stop_handler()
+	{
+		std::signal(SIGTERM, handle_stop_signal);
+	}
+
+	void request_stop()
+	{
+		stop_flag.store(true, std::memory_order_relaxed);
+	}
+
+	bool stop_requested()
+	{
+		return stop_flag.load(std::memory_order_relaxed);
+	}
+} // namespace poly::utils
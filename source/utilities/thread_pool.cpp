@@ -0,0 +1,191 @@
+#include "utilities/thread_pool.hpp"
+#include "utilities/cpu_topology.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace poly::utils
+{
+	static std::unique_ptr<ThreadPool> shared_pool;
+	static std::once_flag shared_pool_flag;
+	static thread_local std::size_t worker_index = ThreadPool::npos;
+
+	/**
+	Starts the worker threads. When pinned, worker i runs on the i-th usable
+	CPU; those are grouped by NUMA node, so neighbouring workers share a node
+
+	@param num_threads the number of worker threads
+	@param pin_threads whether to restrict each worker to a single CPU
+	*/
+	ThreadPool::ThreadPool(std::size_t num_threads, bool pin_threads) :
+		m_stopping{false}
+	{
+		num_threads = std::max<std::size_t>(num_threads, 1);
+		m_worker_nodes.assign(num_threads, 0);
+
+		CpuTopology const& topology = cpu_topology();
+		pin_threads					= pin_threads && !topology.cpus.empty();
+		if (pin_threads) {
+			std::clog << "INFO: pinning " << num_threads << " threads to cores"
+					  << std::endl;
+		}
+
+		for (std::size_t i{0}; i < num_threads; ++i) {
+			int cpu{-1};
+			if (pin_threads) {
+				std::size_t slot  = i % topology.cpus.size();
+				cpu				  = topology.cpus[slot];
+				m_worker_nodes[i] = topology.nodes[slot];
+			}
+			m_workers.emplace_back([this, i, cpu]() { work(i, cpu); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+		m_cv.notify_all();
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	/**
+	Creates the process-wide pool. Only the first call has an effect, so the
+	pool should be sized before anything submits work to it
+
+	@param num_threads the number of worker threads
+	@param pin_threads whether to restrict each worker to a single CPU
+	*/
+	void ThreadPool::initialize(std::size_t num_threads, bool pin_threads)
+	{
+		std::call_once(shared_pool_flag, [num_threads, pin_threads]() {
+			shared_pool =
+				std::make_unique<ThreadPool>(num_threads, pin_threads);
+		});
+	}
+
+	/**
+	@returns the process-wide pool, created with one thread per available
+	core if it was never initialized
+	*/
+	ThreadPool& ThreadPool::instance()
+	{
+		initialize(available_cores());
+		return *shared_pool;
+	}
+
+	std::size_t ThreadPool::current_worker()
+	{
+		return worker_index;
+	}
+
+	std::size_t ThreadPool::size() const
+	{
+		return m_workers.size();
+	}
+
+	std::vector<std::size_t> const& ThreadPool::worker_nodes() const
+	{
+		return m_worker_nodes;
+	}
+
+	/**
+	Runs body over [0, count). Indices are claimed from a shared counter by the
+	caller and by up to max_workers - 1 pool tasks. Helpers that only start once
+	every index is claimed return straight away, so the caller waits only for
+	the helpers that are actually running
+
+	@param count the number of indices
+	@param body the work for one index
+	@param max_workers the most threads to use, including the caller (0 for the
+	whole pool)
+	*/
+	void ThreadPool::parallel_for(std::size_t count,
+								  std::function<void(std::size_t)> const& body,
+								  std::size_t max_workers)
+	{
+		if (count == 0) {
+			return;
+		}
+
+		struct Loop
+		{
+			std::function<void(std::size_t)> body;
+			std::size_t count;
+			std::atomic<std::size_t> next{0};
+			std::mutex mutex;
+			std::condition_variable done;
+			std::size_t running{0};
+		};
+		auto loop	= std::make_shared<Loop>();
+		loop->body	= body;
+		loop->count = count;
+
+		auto run = [](Loop& state) {
+			for (std::size_t i = state.next++; i < state.count;
+				 i			   = state.next++) {
+				state.body(i);
+			}
+		};
+
+		if (max_workers == 0) {
+			max_workers = size() + 1;
+		}
+		std::size_t helpers = std::min({max_workers - 1, size(), count - 1});
+		for (std::size_t h{0}; h < helpers; ++h) {
+			enqueue([loop, run]() {
+				{
+					const std::lock_guard<std::mutex> lock(loop->mutex);
+					++loop->running;
+				}
+				run(*loop);
+				const std::lock_guard<std::mutex> lock(loop->mutex);
+				if (--loop->running == 0) {
+					loop->done.notify_all();
+				}
+			});
+		}
+
+		run(*loop);
+
+		// Every index is claimed, wait for the helpers still working on theirs
+		std::unique_lock<std::mutex> lock(loop->mutex);
+		loop->done.wait(lock, [&loop]() { return loop->running == 0; });
+	}
+
+	void ThreadPool::enqueue(std::function<void()> task)
+	{
+		{
+			const std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+		}
+		m_cv.notify_one();
+	}
+
+	void ThreadPool::work(std::size_t index, int cpu)
+	{
+		worker_index = index;
+		if (cpu >= 0 && !pin_current_thread(cpu)) {
+			std::clog << "WARN: could not pin thread " << index << " to core "
+					  << cpu << std::endl;
+		}
+
+		while (true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cv.wait(lock,
+						  [this]() { return m_stopping || !m_tasks.empty(); });
+				if (m_stopping && m_tasks.empty()) {
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+} // namespace poly::utils
@@ -1,5 +1,9 @@
+#include <atomic>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include "utilities/utilities.hpp"
+#include "utilities/random.hpp"
 #include "stb_image_write.h"
 #include "structures/world.hpp"
 
@@ -70,13 +74,62 @@ namespace poly::utils
 			data.data());
 	}
 
+	/**
+	 * Saves the raw photon mapping accumulator so that the output of several
+	 * workers can be summed (see hypercube_app/merge_accumulators.py). The
+	 * layout is the 4 byte tag "SPPM", then width, height and the number of
+	 * iterations as little endian uint32, followed by width * height RGB
+	 * float32 triplets starting at the top row.
+	 *
+	 * @param filename The name of the file to save to.
+	 * @param storage The unscaled sum of all iterations, row major.
+	 * @param width The width of the image.
+	 * @param height The height of the image.
+	 * @param num_iterations The number of iterations summed into storage.
+	 */
+	void save_accumulator(std::string const& filename,
+						  std::vector<Colour> const& storage,
+						  int width,
+						  int height,
+						  std::size_t num_iterations)
+	{
+		std::clog << "INFO: writing accumulator to " << filename << std::endl;
+		std::ofstream fs(filename, std::ios::out | std::ios::binary);
+		if (!fs) {
+			std::cerr << "ERROR: could not open '" << filename << "'"
+					  << std::endl;
+			return;
+		}
+
+		std::uint32_t header[3] = {static_cast<std::uint32_t>(width),
+								   static_cast<std::uint32_t>(height),
+								   static_cast<std::uint32_t>(num_iterations)};
+		fs.write("SPPM", 4);
+		fs.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+		std::vector<float> data;
+		data.reserve(storage.size() * 3);
+		for (Colour const& pixel : storage) {
+			data.push_back(pixel.r);
+			data.push_back(pixel.g);
+			data.push_back(pixel.b);
+		}
+		fs.write(reinterpret_cast<const char*>(data.data()),
+				 static_cast<std::streamsize>(data.size() * sizeof(float)));
+	}
+
 	Colour random_colour_generate()
 	{
+		// Each call takes the next stream, so colours only depend on the
+		// order materials are created in
+		static std::atomic<std::uint64_t> colours_generated{0};
+		Random rng{RandomDomain::colour, {colours_generated++}};
+
 		unsigned int granularity = 256;
 		Colour colour;
-		colour.x = (rand() % granularity) / (float)granularity;
-		colour.y = (rand() % granularity) / (float)granularity;
-		colour.z = (rand() % granularity) / (float)granularity;
+		colour.x = rng.uniform(granularity) / (float)granularity;
+		colour.y = rng.uniform(granularity) / (float)granularity;
+		colour.z = rng.uniform(granularity) / (float)granularity;
 		return colour;
 	}
 
@@ -105,6 +158,11 @@ namespace poly::utils
 		}
 	}
 
+	float colour_luminance(Colour const& colour)
+	{
+		return 0.2126f * colour.r + 0.7152f * colour.g + 0.0722f * colour.b;
+	}
+
 	atlas::math::Vector reflect_over_normal(const math::Vector& wi,
 											const atlas::math::Normal n)
 	{
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "integrators/SPPMIntegrator.hpp"
+#include "utilities/utilities.hpp"
+
+using poly::integrators::AccumulationBuffer;
+using poly::integrators::VisiblePoint;
+
+static int failures = 0;
+
+static void check(bool condition, std::string const& what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+/**
+Makes a visible point for pixel (col, row) of the output image, row 0 being
+the top row
+
+@param width the width of the image
+@param height the height of the image
+@param col the pixel column
+@param row the pixel row
+@param contribution what the point gathered this iteration
+
+@returns the visible point, as the integrator hands it to fold
+*/
+static std::shared_ptr<poly::object::Object> visible_point(int width,
+														   int height,
+														   int col,
+														   int row,
+														   Colour const& contribution)
+{
+	auto vp			 = std::make_shared<VisiblePoint>();
+	vp->index_x		 = col - width / 2;
+	vp->index_y		 = height - 1 - row - height / 2;
+	vp->contribution = contribution;
+	return vp;
+}
+
+static void test_fold_sums_iterations()
+{
+	// Taller than one band, so that several band locks are taken
+	const int width{4}, height{40};
+	AccumulationBuffer storage(width, height);
+
+	std::vector<std::shared_ptr<poly::object::Object>> iteration;
+	iteration.push_back(visible_point(width, height, 0, 0, Colour{1.0f, 2.0f, 3.0f}));
+	iteration.push_back(visible_point(width, height, 3, 39, Colour{0.5f, 0.5f, 0.5f}));
+	iteration.push_back(visible_point(width, height, 2, 20, Colour{1.0f, 1.0f, 1.0f}));
+	// Outside the frame, dropped
+	iteration.push_back(visible_point(width, height, width, 0, Colour{9.0f, 9.0f, 9.0f}));
+
+	// Nothing was there before, every pixel changed completely
+	check(std::abs(storage.fold(iteration) - 1.0f) < 1.0e-6f,
+		  "first fold reports a relative change of 1");
+
+	// The same estimate again leaves the average unchanged
+	check(std::abs(storage.fold(iteration)) < 1.0e-6f,
+		  "repeating an iteration reports no change");
+
+	std::vector<Colour> const& sum = storage.sum();
+	check(sum.size() == static_cast<std::size_t>(width * height),
+		  "sum covers the frame");
+	check(sum[0] == Colour(2.0f, 4.0f, 6.0f), "top left pixel summed");
+	check(sum[39 * width + 3] == Colour(1.0f, 1.0f, 1.0f),
+		  "bottom right pixel summed");
+	check(sum[20 * width + 2] == Colour(2.0f, 2.0f, 2.0f),
+		  "pixel in a later band summed");
+
+	Colour total{0.0f};
+	for (Colour const& pixel : sum) {
+		total += pixel;
+	}
+	check(total == Colour(5.0f, 7.0f, 9.0f),
+		  "points outside the frame are dropped");
+}
+
+static void test_accumulator_round_trip()
+{
+	const int width{3}, height{2};
+	std::vector<Colour> storage;
+	for (int i{0}; i < width * height; ++i) {
+		storage.emplace_back(0.25f * i, 1.0f + i, -0.5f * i);
+	}
+
+	const std::string filename = "test_accumulation.bin";
+	poly::utils::save_accumulator(filename, storage, width, height, 7);
+
+	std::ifstream file(filename, std::ios::in | std::ios::binary);
+	char tag[4];
+	std::uint32_t header[3];
+	file.read(tag, sizeof(tag));
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	std::vector<float> data(storage.size() * 3);
+	file.read(reinterpret_cast<char*>(data.data()),
+			  static_cast<std::streamsize>(data.size() * sizeof(float)));
+	check(static_cast<bool>(file), "accumulator file holds every pixel");
+	check(file.peek() == std::ifstream::traits_type::eof(),
+		  "accumulator file has nothing after the pixels");
+	file.close();
+	std::remove(filename.c_str());
+
+	check(std::memcmp(tag, "SPPM", 4) == 0, "accumulator tag");
+	check(header[0] == static_cast<std::uint32_t>(width) &&
+			  header[1] == static_cast<std::uint32_t>(height) && header[2] == 7,
+		  "accumulator header");
+	for (std::size_t i{0}; i < storage.size(); ++i) {
+		check(Colour(data[3 * i], data[3 * i + 1], data[3 * i + 2]) ==
+				  storage[i],
+			  "accumulator pixel " + std::to_string(i));
+	}
+}
+
+int main()
+{
+	test_fold_sums_iterations();
+	test_accumulator_round_trip();
+	return failures == 0 ? 0 : 1;
+}
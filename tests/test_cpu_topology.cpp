@@ -0,0 +1,55 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utilities/cpu_topology.hpp"
+
+using poly::utils::parse_cpu_list;
+using poly::utils::quota_to_cores;
+
+static int failures = 0;
+
+static void check(bool condition, std::string const& what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+static void test_parse_cpu_list()
+{
+	check(parse_cpu_list("0-3,8,10-11") ==
+			  std::vector<int>({0, 1, 2, 3, 8, 10, 11}),
+		  "ranges and single CPUs");
+	check(parse_cpu_list("5") == std::vector<int>({5}), "single CPU");
+	check(parse_cpu_list("").empty(), "empty list");
+	check(parse_cpu_list("0-1,,4") == std::vector<int>({0, 1, 4}),
+		  "empty entries are skipped");
+	check(parse_cpu_list("2-1").empty(), "reversed range is empty");
+	check(parse_cpu_list("0,x,3-y,6") == std::vector<int>({0, 6}),
+		  "malformed entries are skipped");
+	// Kernel files end with a newline
+	check(parse_cpu_list("0-2\n") == std::vector<int>({0, 1, 2}),
+		  "trailing newline");
+}
+
+static void test_quota_to_cores()
+{
+	// cpu.max "200000 100000", two full cores
+	check(quota_to_cores(200000.0, 100000.0) == 2, "whole cores");
+	// A quota of 1.5 cores can keep two threads partly busy
+	check(quota_to_cores(150000.0, 100000.0) == 2, "partial cores round up");
+	check(quota_to_cores(10000.0, 100000.0) == 1, "small quota is one core");
+	// cfs_quota_us is -1 without a limit
+	check(quota_to_cores(-1.0, 100000.0) == 0, "negative quota is unlimited");
+	check(quota_to_cores(0.0, 100000.0) == 0, "zero quota is unlimited");
+	check(quota_to_cores(100000.0, 0.0) == 0, "zero period is unlimited");
+}
+
+int main()
+{
+	test_parse_cpu_list();
+	test_quota_to_cores();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lights/ambient.hpp"
+#include "lights/point_light.hpp"
+#include "structures/light_tree.hpp"
+#include "utilities/random.hpp"
+
+using poly::structures::LightSample;
+using poly::structures::LightTree;
+
+static int failures = 0;
+
+static void check(bool condition, std::string const& what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+/**
+@returns an ambient light, which stays outside the tree, followed by point
+lights of different powers spread around the origin
+*/
+static std::vector<std::shared_ptr<poly::light::Light>> scene_lights()
+{
+	std::vector<std::shared_ptr<poly::light::Light>> lights;
+	lights.push_back(std::make_shared<poly::light::AmbientLight>());
+
+	const float positions[][3] = {{0.0f, 4.0f, 0.0f},
+								  {3.0f, 4.0f, 1.0f},
+								  {-2.0f, 5.0f, -2.0f},
+								  {6.0f, 2.0f, 4.0f},
+								  {-5.0f, 3.0f, 5.0f},
+								  {1.0f, 8.0f, -6.0f},
+								  {-7.0f, 6.0f, -1.0f}};
+	for (std::size_t l{0}; l < 7; ++l) {
+		auto light = std::make_shared<poly::light::PointLight>(atlas::math::Vector(
+			positions[l][0], positions[l][1], positions[l][2]));
+		light->radiance_scale(1.0f + static_cast<float>(l));
+		light->colour_set(Colour{1.0f, 0.5f + 0.1f * l, 0.25f});
+		lights.push_back(light);
+	}
+	return lights;
+}
+
+static void test_sample_is_unbiased()
+{
+	auto lights = scene_lights();
+	LightTree tree(lights);
+	check(tree.size() == lights.size() - 1, "only positioned lights are placed");
+
+	// Shading from the picked lights, weighted, must on average equal
+	// shading from every light: each light's mean weight is 1
+	const atlas::math::Point point{0.5f, 0.0f, 0.5f};
+	const std::size_t trials{200000};
+	std::vector<double> weights(lights.size(), 0.0);
+	std::vector<LightSample> samples;
+	bool merged{true};
+	for (std::size_t trial{0}; trial < trials; ++trial) {
+		poly::utils::Random rng{poly::utils::RandomDomain::light, {trial}};
+		tree.sample(point, 2, rng, samples);
+
+		std::vector<bool> seen(lights.size(), false);
+		for (LightSample const& sample : samples) {
+			merged = merged && !seen[sample.light];
+			seen[sample.light] = true;
+			weights[sample.light] += sample.weight;
+		}
+	}
+	check(merged, "lights picked twice are merged");
+	check(weights[0] == static_cast<double>(trials),
+		  "lights outside the tree are always shaded at full weight");
+
+	bool unbiased{true};
+	for (std::size_t l{1}; l < lights.size(); ++l) {
+		double mean = weights[l] / trials;
+		if (std::abs(mean - 1.0) > 0.03) {
+			std::cerr << "light " << l << " has mean weight " << mean << std::endl;
+			unbiased = false;
+		}
+	}
+	check(unbiased, "every light has a mean weight of 1");
+}
+
+static void test_sample_power()
+{
+	auto lights = scene_lights();
+	LightTree tree(lights);
+
+	float total{0.0f};
+	for (std::size_t l{1}; l < lights.size(); ++l) {
+		total += lights[l]->power();
+	}
+
+	// Stratified draws pick each light in proportion to its power, with the
+	// pdf it reports
+	const std::size_t strata{70000};
+	std::vector<std::size_t> picks(lights.size(), 0);
+	bool pdfs{true};
+	for (std::size_t s{0}; s < strata; ++s) {
+		float pdf{0.0f};
+		std::uint32_t light = tree.sample_power((s + 0.5f) / strata, pdf);
+		++picks[light];
+		pdfs = pdfs && std::abs(pdf - lights[light]->power() / total) < 1.0e-5f;
+	}
+	check(pdfs, "sample_power reports each light's share of the power");
+	check(picks[0] == 0, "sample_power never picks a light outside the tree");
+
+	bool proportional{true};
+	for (std::size_t l{1}; l < lights.size(); ++l) {
+		float expected = strata * lights[l]->power() / total;
+		proportional = proportional && std::abs(picks[l] - expected) <= 2.0f;
+	}
+	check(proportional, "stratified draws pick lights in proportion to power");
+}
+
+int main()
+{
+	test_sample_is_unbiased();
+	test_sample_power();
+	return failures == 0 ? 0 : 1;
+}
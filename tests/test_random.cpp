@@ -0,0 +1,118 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utilities/random.hpp"
+
+using poly::utils::Random;
+using poly::utils::RandomDomain;
+
+static int failures = 0;
+
+static void check(bool condition, std::string const& what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+static std::vector<std::uint32_t> draws(Random rng, std::size_t count)
+{
+	std::vector<std::uint32_t> values;
+	for (std::size_t i{0}; i < count; ++i) {
+		values.push_back(rng.next());
+	}
+	return values;
+}
+
+static void test_streams_are_keyed()
+{
+	auto first = draws(Random{RandomDomain::camera, {3, 7, 1}}, 16);
+	check(first == draws(Random{RandomDomain::camera, {3, 7, 1}}, 16),
+		  "the same key repeats its stream");
+	check(first != draws(Random{RandomDomain::camera, {3, 7, 2}}, 16),
+		  "neighbouring keys differ");
+	check(first != draws(Random{RandomDomain::camera, {7, 3, 1}}, 16),
+		  "key order matters");
+	check(first != draws(Random{RandomDomain::photon, {3, 7, 1}}, 16),
+		  "domains separate streams with the same key");
+
+	poly::utils::set_random_seed(42);
+	auto seeded = draws(Random{RandomDomain::camera, {3, 7, 1}}, 16);
+	check(seeded != first, "the global seed changes every stream");
+	check(seeded == draws(Random{RandomDomain::camera, {3, 7, 1}}, 16),
+		  "a seeded stream repeats too");
+	poly::utils::set_random_seed(0);
+	check(first == draws(Random{RandomDomain::camera, {3, 7, 1}}, 16),
+		  "restoring the seed restores the stream");
+
+	check(poly::utils::float_key({1.0f, -2.5f}) ==
+			  poly::utils::float_key({1.0f, -2.5f}),
+		  "float keys repeat");
+	check(poly::utils::float_key({1.0f, -2.5f}) !=
+			  poly::utils::float_key({-2.5f, 1.0f}),
+		  "float keys depend on order");
+	check(poly::utils::float_key({0.0f}) != poly::utils::float_key({-0.0f}),
+		  "float keys use the bits of the floats");
+}
+
+static void test_uniform_float()
+{
+	Random rng{RandomDomain::sampler, {1}};
+	const std::size_t count{100000};
+	double sum{0.0};
+	bool in_range{true};
+	for (std::size_t i{0}; i < count; ++i) {
+		float u = rng.uniform();
+		in_range = in_range && u >= 0.0f && u < 1.0f;
+		sum += u;
+	}
+	check(in_range, "uniform() stays in [0, 1)");
+	check(std::abs(sum / count - 0.5) < 0.01, "uniform() averages 1/2");
+}
+
+static void test_uniform_bound_is_unbiased()
+{
+	// A plain modulo by 3 * 2^30 would land in the lowest 2^30 values for
+	// half of the draws instead of a third
+	const std::uint32_t bound{3u << 30u};
+	Random rng{RandomDomain::roulette, {2}};
+	const std::size_t count{60000};
+	std::size_t lowest_third{0};
+	bool in_range{true};
+	for (std::size_t i{0}; i < count; ++i) {
+		std::uint32_t value = rng.uniform(bound);
+		in_range = in_range && value < bound;
+		if (value < (1u << 30u)) {
+			++lowest_third;
+		}
+	}
+	check(in_range, "uniform(bound) stays below the bound");
+	check(std::abs(static_cast<double>(lowest_third) / count - 1.0 / 3.0) < 0.01,
+		  "uniform(bound) has no modulo bias");
+
+	// Small bounds: every value about equally often
+	const std::uint32_t faces{6};
+	std::vector<std::size_t> counts(faces, 0);
+	for (std::size_t i{0}; i < count; ++i) {
+		++counts[rng.uniform(faces)];
+	}
+	bool even{true};
+	for (std::size_t c : counts) {
+		even = even && std::abs(static_cast<double>(c) / count - 1.0 / faces) < 0.01;
+	}
+	check(even, "uniform(6) hits every value equally often");
+	check(Random{RandomDomain::light, {3}}.uniform(1) == 0,
+		  "uniform(1) is always 0");
+}
+
+int main()
+{
+	test_streams_are_keyed();
+	test_uniform_float();
+	test_uniform_bound_is_unbiased();
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "samplers/blue_noise.hpp"
+#include "samplers/halton.hpp"
+#include "samplers/jittered.hpp"
+#include "samplers/sobol.hpp"
+
+using poly::sampler::Sampler;
+
+static int failures = 0;
+
+static void check(bool condition, std::string const& what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+// Pixels the per pixel samplers are checked at, including negative ones
+static const int pixels[][2] = {{0, 0}, {1, 0}, {0, 1}, {17, 5}, {-3, 8}, {250, -120}};
+
+/**
+@param sampler the sampler to draw from
+@param x the pixel column
+@param y the pixel row
+@param count the number of samples
+
+@returns the first count samples of the pixel
+*/
+static std::vector<atlas::math::Vector2>
+pixel_samples(Sampler const& sampler, int x, int y, unsigned int count)
+{
+	std::vector<atlas::math::Vector2> points;
+	for (unsigned int i{0}; i < count; ++i) {
+		points.push_back(sampler.sample_pixel(x, y, i));
+	}
+	return points;
+}
+
+/**
+@param points the points to test
+@param cells_x the number of columns of the grid over the unit square
+@param cells_y the number of rows of the grid
+
+@returns whether every cell of the grid holds the same number of points
+*/
+static bool stratified(std::vector<atlas::math::Vector2> const& points,
+					   unsigned int cells_x,
+					   unsigned int cells_y)
+{
+	std::vector<unsigned int> counts(cells_x * cells_y, 0);
+	for (atlas::math::Vector2 const& point : points) {
+		auto cx = static_cast<unsigned int>(point.x * cells_x);
+		auto cy = static_cast<unsigned int>(point.y * cells_y);
+		++counts[cy * cells_x + cx];
+	}
+	return std::all_of(counts.begin(), counts.end(), [&](unsigned int c) {
+		return c == counts.front();
+	});
+}
+
+/**
+@param values coordinates in [0, 1)
+
+@returns the largest gap between neighbouring values, wrapping around 1
+*/
+static float largest_gap(std::vector<float> values)
+{
+	std::sort(values.begin(), values.end());
+	float gap = values.front() + 1.0f - values.back();
+	for (std::size_t i{1}; i < values.size(); ++i) {
+		gap = std::max(gap, values[i] - values[i - 1]);
+	}
+	return gap;
+}
+
+/**
+@param points points in [0, 1)^2
+
+@returns the smallest distance between two of the points, on the torus so
+that the per pixel shift does not matter
+*/
+static float closest_pair(std::vector<atlas::math::Vector2> const& points)
+{
+	float closest{2.0f};
+	for (std::size_t i{0}; i < points.size(); ++i) {
+		for (std::size_t j{i + 1}; j < points.size(); ++j) {
+			float dx = std::abs(points[i].x - points[j].x);
+			float dy = std::abs(points[i].y - points[j].y);
+			dx		 = std::min(dx, 1.0f - dx);
+			dy		 = std::min(dy, 1.0f - dy);
+			closest	 = std::min(closest, std::sqrt(dx * dx + dy * dy));
+		}
+	}
+	return closest;
+}
+
+/**
+@param a the samples of one pixel
+@param b the samples of another pixel, at least as many as a
+
+@returns whether, for some offset k > 0, sample i of b is sample i + k of a
+for every i, on the torus and up to rounding
+*/
+static bool index_shifted(std::vector<atlas::math::Vector2> const& a,
+						  std::vector<atlas::math::Vector2> const& b)
+{
+	auto close = [](float p, float q) {
+		float d = std::abs(p - q);
+		return std::min(d, 1.0f - d) < 1.0e-5f;
+	};
+	for (std::size_t k{1}; k < a.size(); ++k) {
+		bool shifted{true};
+		for (std::size_t i{0}; shifted && i + k < a.size(); ++i) {
+			shifted = close(b[i].x, a[i + k].x) && close(b[i].y, a[i + k].y);
+		}
+		if (shifted) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+Checks what every per pixel sampler must do: samples in [0, 1)^2, the same
+sample for the same pixel and index, and different patterns per pixel
+
+@param sampler the sampler to check
+@param name names the sampler in failure messages
+*/
+static void check_per_pixel(Sampler const& sampler, std::string const& name)
+{
+	bool in_range{true};
+	for (auto const& pixel : pixels) {
+		for (atlas::math::Vector2 const& point :
+			 pixel_samples(sampler, pixel[0], pixel[1], 256)) {
+			in_range = in_range && point.x >= 0.0f && point.x < 1.0f &&
+					   point.y >= 0.0f && point.y < 1.0f;
+		}
+	}
+	check(in_range, name + ": samples stay in [0, 1)^2");
+
+	check(pixel_samples(sampler, 17, 5, 16) == pixel_samples(sampler, 17, 5, 16),
+		  name + ": samples repeat for the same pixel");
+	check(pixel_samples(sampler, 17, 5, 16) != pixel_samples(sampler, 18, 5, 16),
+		  name + ": neighbouring pixels get different samples");
+
+	// Neighbours sharing points with shifted indices would line their
+	// errors up along the rows and columns
+	bool independent{true};
+	for (auto const& pixel : pixels) {
+		auto samples = pixel_samples(sampler, pixel[0], pixel[1], 16);
+		independent =
+			independent &&
+			!index_shifted(samples, pixel_samples(sampler, pixel[0] + 1, pixel[1], 16)) &&
+			!index_shifted(samples, pixel_samples(sampler, pixel[0], pixel[1] + 1, 16));
+	}
+	check(independent,
+		  name + ": neighbouring pixels are not the same samples with shifted indices");
+}
+
+static void test_sobol()
+{
+	poly::sampler::AA_Sobol sampler(16);
+	check_per_pixel(sampler, "sobol");
+
+	// Every power of two prefix is a (0, m, 2)-net, scrambling keeps it one
+	bool nets{true};
+	for (auto const& pixel : pixels) {
+		auto points = pixel_samples(sampler, pixel[0], pixel[1], 16);
+		nets = nets && stratified(points, 4, 4) && stratified(points, 16, 1) &&
+			   stratified(points, 1, 16) && stratified(points, 8, 2) &&
+			   stratified(points, 2, 8);
+	}
+	check(nets, "sobol: 16 samples form a (0, 4, 2)-net");
+}
+
+static void test_halton()
+{
+	poly::sampler::AA_Halton sampler(16);
+	check_per_pixel(sampler, "halton");
+
+	// The per pixel shift moves every point the same way, so the radical
+	// inverses stay evenly spaced
+	bool spaced{true};
+	for (auto const& pixel : pixels) {
+		std::vector<float> u, v;
+		for (atlas::math::Vector2 const& point :
+			 pixel_samples(sampler, pixel[0], pixel[1], 9)) {
+			v.push_back(point.y);
+		}
+		for (atlas::math::Vector2 const& point :
+			 pixel_samples(sampler, pixel[0], pixel[1], 8)) {
+			u.push_back(point.x);
+		}
+		spaced = spaced && std::abs(largest_gap(u) - 1.0f / 8.0f) < 1.0e-5f &&
+				 std::abs(largest_gap(v) - 1.0f / 9.0f) < 1.0e-5f;
+	}
+	check(spaced, "halton: 8 samples in base 2 and 9 in base 3 are evenly spaced");
+}
+
+static void test_blue_noise()
+{
+	poly::sampler::AA_BlueNoise sampler(16);
+	check_per_pixel(sampler, "R2");
+
+	// Points of the R2 sequence keep apart, random points would come within
+	// a fraction of this distance of each other
+	bool spread{true};
+	for (auto const& pixel : pixels) {
+		auto points = pixel_samples(sampler, pixel[0], pixel[1], 64);
+		spread = spread && closest_pair(points) > 0.5f / std::sqrt(64.0f);
+	}
+	check(spread, "R2: 64 samples are evenly spread");
+}
+
+static void test_jittered()
+{
+	const unsigned int n{4}, sets{3};
+	poly::sampler::AA_Jittered sampler(n * n, sets);
+	check(sampler.get_num_samples() == n * n * sets, "jittered: sample count");
+
+	bool jittered{true};
+	for (unsigned int set{0}; set < sets; ++set) {
+		std::vector<atlas::math::Vector2> points;
+		for (unsigned int i{0}; i < n * n; ++i) {
+			points.push_back(sampler.sample_unit_square(set * n * n + i));
+		}
+		jittered = jittered && stratified(points, n, n);
+	}
+	check(jittered, "jittered: one sample per cell in every set");
+
+	// Cursors walk the flat array and wrap around
+	Sampler::Cursor cursor;
+	bool sequence{true};
+	for (unsigned int i{0}; i < 2 * sampler.get_num_samples(); ++i) {
+		sequence = sequence &&
+				   sampler.sample_unit_square(cursor) ==
+					   sampler.sample_unit_square(i % sampler.get_num_samples());
+	}
+	check(sequence, "jittered: cursors walk the samples in order");
+
+	bool threw{false};
+	try {
+		sampler.sample_hemisphere(0u);
+	}
+	catch (std::logic_error const&) {
+		threw = true;
+	}
+	check(threw, "hemisphere samples throw before they are mapped");
+
+	sampler.map_samples_to_hemisphere(1.0f);
+	bool on_hemisphere{true};
+	for (unsigned int i{0}; i < sampler.get_num_samples(); ++i) {
+		atlas::math::Vector direction = sampler.sample_hemisphere(i);
+		on_hemisphere = on_hemisphere && direction.z >= 0.0f &&
+						std::abs(glm::length(direction) - 1.0f) < 1.0e-4f;
+	}
+	check(on_hemisphere, "hemisphere samples are unit vectors facing +z");
+}
+
+int main()
+{
+	test_sobol();
+	test_halton();
+	test_blue_noise();
+	test_jittered();
+	return failures == 0 ? 0 : 1;
+}
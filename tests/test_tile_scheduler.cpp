@@ -0,0 +1,169 @@
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "structures/tile_scheduler.hpp"
+
+using poly::structures::BinnedPrimitive;
+using poly::structures::scene_slab;
+using poly::structures::TileScheduler;
+
+static int failures = 0;
+
+static void check(bool condition, std::string const& what)
+{
+	if (!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		++failures;
+	}
+}
+
+// Frame of slabs_x by slabs_y slabs of slab_size pixels each
+static const int slab_size{32};
+static const int slabs_x{6};
+static const int slabs_y{5};
+static const int frame_width{slabs_x * slab_size};
+static const int frame_height{slabs_y * slab_size};
+
+/**
+@returns the slabs covering the frame, each with one binned primitive
+covering the whole slab, as a hybrid render bins them
+*/
+static std::vector<std::shared_ptr<scene_slab>> frame_slabs()
+{
+	std::vector<std::shared_ptr<scene_slab>> slabs;
+	for (int y{0}; y < frame_height; y += slab_size) {
+		for (int x{0}; x < frame_width; x += slab_size) {
+			auto slab = std::make_shared<scene_slab>(
+				nullptr, nullptr, x, x + slab_size, y, y + slab_size);
+			slab->primitives.push_back({nullptr, x, x + slab_size, y, y + slab_size});
+			slabs.push_back(slab);
+		}
+	}
+	return slabs;
+}
+
+/**
+Checks that the slabs handed out cover every pixel of the frame exactly
+once, and that each kept the primitive binned to the slab it came from
+
+@param taken the slabs handed out by the scheduler
+@param what names the case in failure messages
+*/
+static void check_coverage(std::vector<std::shared_ptr<scene_slab>> const& taken,
+						   std::string const& what)
+{
+	std::vector<int> coverage(frame_width * frame_height, 0);
+	bool primitives_kept{true};
+	for (auto const& slab : taken) {
+		for (int y{slab->start_y}; y < slab->end_y; ++y) {
+			for (int x{slab->start_x}; x < slab->end_x; ++x) {
+				++coverage[y * frame_width + x];
+			}
+		}
+
+		if (slab->primitives.size() != 1) {
+			primitives_kept = false;
+			continue;
+		}
+		BinnedPrimitive const& binned = slab->primitives.front();
+		primitives_kept = primitives_kept && binned.start_x <= slab->start_x &&
+						  slab->end_x <= binned.end_x &&
+						  binned.start_y <= slab->start_y &&
+						  slab->end_y <= binned.end_y;
+	}
+
+	bool exactly_once{true};
+	for (int count : coverage) {
+		exactly_once = exactly_once && count == 1;
+	}
+	check(exactly_once, what + ": every pixel handed out exactly once");
+	check(primitives_kept, what + ": slabs keep their binned primitive");
+}
+
+static void test_single_worker_steals()
+{
+	// Only worker 0 asks, so it drains its own queue, then steals the rest
+	TileScheduler scheduler(frame_slabs(), 4, 8);
+	std::vector<std::shared_ptr<scene_slab>> taken;
+	while (std::shared_ptr<scene_slab> slab = scheduler.next(0)) {
+		taken.push_back(slab);
+		scheduler.complete();
+	}
+
+	check_coverage(taken, "single worker");
+	check(scheduler.completed() == scheduler.total(),
+		  "single worker: every slab completed");
+	check(taken.size() > static_cast<std::size_t>(slabs_x * slabs_y),
+		  "single worker: the last slabs are split");
+	for (auto const& slab : taken) {
+		if (slab->end_x - slab->start_x < 8 || slab->end_y - slab->start_y < 8) {
+			check(false, "single worker: slabs are not split below the minimum");
+			break;
+		}
+	}
+}
+
+static void test_concurrent_workers()
+{
+	const std::size_t num_workers{4};
+	TileScheduler scheduler(frame_slabs(), num_workers, 8, {0, 0, 1, 1});
+
+	std::mutex taken_mutex;
+	std::vector<std::shared_ptr<scene_slab>> taken;
+	std::vector<std::size_t> claimed;
+	std::vector<std::thread> threads;
+	for (std::size_t t{0}; t < num_workers; ++t) {
+		threads.emplace_back([&, t]() {
+			// Every thread asks for the same queue, they must still get
+			// different ones
+			std::size_t worker = scheduler.claim(0, t / 2);
+			std::vector<std::shared_ptr<scene_slab>> mine;
+			while (std::shared_ptr<scene_slab> slab = scheduler.next(worker)) {
+				mine.push_back(slab);
+				scheduler.complete();
+			}
+
+			const std::lock_guard<std::mutex> lock(taken_mutex);
+			claimed.push_back(worker);
+			taken.insert(taken.end(), mine.begin(), mine.end());
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	check_coverage(taken, "concurrent workers");
+	check(scheduler.completed() == scheduler.total(),
+		  "concurrent workers: every slab completed");
+
+	std::vector<bool> seen(num_workers, false);
+	bool distinct{true};
+	for (std::size_t worker : claimed) {
+		distinct = distinct && worker < num_workers && !seen[worker];
+		if (worker < num_workers) {
+			seen[worker] = true;
+		}
+	}
+	check(distinct, "concurrent workers: every worker claims its own queue");
+}
+
+static void test_claim_prefers_node()
+{
+	TileScheduler scheduler(frame_slabs(), 4, 8, {0, 0, 1, 1});
+	check(scheduler.claim(1, 0) == 1, "claim: a free preferred queue is taken");
+	check(scheduler.claim(1, 1) == 2, "claim: falls back to a queue on its node");
+	check(scheduler.claim(1, 1) == 3, "claim: then to the next on its node");
+	check(scheduler.claim(1, 1) == 0, "claim: then to any free queue");
+}
+
+int main()
+{
+	test_single_worker_steals();
+	test_concurrent_workers();
+	test_claim_prefers_node();
+	return failures == 0 ? 0 : 1;
+}